@@ -5,6 +5,8 @@
 #include "hb-ft.h"
 #include FT_OUTLINE_H
 
+#include "perf-heap.hh"
+
 #ifdef HAVE_TTFPARSER
 #include "ttfparser.h"
 #endif
@@ -12,24 +14,26 @@
 #define HB_UNUSED __attribute__((unused))
 
 static void
-_hb_move_to (hb_position_t to_x HB_UNUSED, hb_position_t to_y HB_UNUSED, void *user_data HB_UNUSED) {}
+_hb_move_to (hb_draw_funcs_t *, void *, hb_draw_state_t *, float, float, void *) {}
 
 static void
-_hb_line_to (hb_position_t to_x HB_UNUSED, hb_position_t to_y HB_UNUSED, void *user_data HB_UNUSED) {}
+_hb_line_to (hb_draw_funcs_t *, void *, hb_draw_state_t *, float, float, void *) {}
 
 static void
-_hb_quadratic_to (hb_position_t control_x HB_UNUSED, hb_position_t control_y HB_UNUSED,
-		  hb_position_t to_x HB_UNUSED, hb_position_t to_y HB_UNUSED,
-		  void *user_data HB_UNUSED) {}
+_hb_quadratic_to (hb_draw_funcs_t *, void *, hb_draw_state_t *,
+		  float, float,
+		  float, float,
+		  void *) {}
 
 static void
-_hb_cubic_to (hb_position_t control1_x HB_UNUSED, hb_position_t control1_y HB_UNUSED,
-	      hb_position_t control2_x HB_UNUSED, hb_position_t control2_y HB_UNUSED,
-	      hb_position_t to_x HB_UNUSED, hb_position_t to_y HB_UNUSED,
-	      void *user_data HB_UNUSED) {}
+_hb_cubic_to (hb_draw_funcs_t *, void *, hb_draw_state_t *,
+	      float, float,
+	      float, float,
+	      float, float,
+	      void *) {}
 
 static void
-_hb_close_path (void *user_data HB_UNUSED) {}
+_hb_close_path (hb_draw_funcs_t *, void *, hb_draw_state_t *, void *) {}
 
 static void
 _ft_move_to (const FT_Vector* to HB_UNUSED, void* user HB_UNUSED) {}
@@ -75,15 +79,27 @@ static void draw (benchmark::State &state, const char *font_path, bool is_var, b
       hb_font_set_variations (font, &wght, 1);
     }
     hb_draw_funcs_t *draw_funcs = hb_draw_funcs_create ();
-    hb_draw_funcs_set_move_to_func (draw_funcs, _hb_move_to);
-    hb_draw_funcs_set_line_to_func (draw_funcs, _hb_line_to);
-    hb_draw_funcs_set_quadratic_to_func (draw_funcs, _hb_quadratic_to);
-    hb_draw_funcs_set_cubic_to_func (draw_funcs, _hb_cubic_to);
-    hb_draw_funcs_set_close_path_func (draw_funcs, _hb_close_path);
+    hb_draw_funcs_set_move_to_func (draw_funcs, _hb_move_to, nullptr, nullptr);
+    hb_draw_funcs_set_line_to_func (draw_funcs, _hb_line_to, nullptr, nullptr);
+    hb_draw_funcs_set_quadratic_to_func (draw_funcs, _hb_quadratic_to, nullptr, nullptr);
+    hb_draw_funcs_set_cubic_to_func (draw_funcs, _hb_cubic_to, nullptr, nullptr);
+    hb_draw_funcs_set_close_path_func (draw_funcs, _hb_close_path, nullptr, nullptr);
+
+#ifdef PERF_HEAP_TRACKING
+    /* Count the allocations a draw makes once the font's tables are loaded;
+     * the interpreters are expected not to need the heap at all. */
+    for (unsigned gid = 0; gid < num_glyphs; ++gid)
+      hb_font_get_glyph_shape (font, gid, draw_funcs, nullptr);
+    heap_tracking_start ();
+    for (unsigned gid = 0; gid < num_glyphs; ++gid)
+      hb_font_get_glyph_shape (font, gid, draw_funcs, nullptr);
+    heap_tracking_stop ();
+    state.counters["allocs/glyph"] = (double) heap_allocs / num_glyphs;
+#endif
 
     for (auto _ : state)
       for (unsigned gid = 0; gid < num_glyphs; ++gid)
-	hb_font_draw_glyph (font, gid, draw_funcs, nullptr);
+	hb_font_get_glyph_shape (font, gid, draw_funcs, nullptr);
 
     hb_draw_funcs_destroy (draw_funcs);
   }
@@ -142,6 +158,53 @@ static void draw (benchmark::State &state, const char *font_path, bool is_var, b
   hb_font_destroy (font);
 }
 
+/* Like an animated variable-font UI: every iteration draws all glyphs at
+ * the next of a sweep of coordinates, from each axis' minimum to maximum. */
+static void draw_sweep (benchmark::State &state, const char *font_path)
+{
+  hb_font_t *font;
+  unsigned num_glyphs;
+  {
+    hb_blob_t *blob = hb_blob_create_from_file_or_fail (font_path);
+    assert (blob);
+    hb_face_t *face = hb_face_create (blob, 0);
+    hb_blob_destroy (blob);
+    num_glyphs = hb_face_get_glyph_count (face);
+    font = hb_font_create (face);
+    hb_face_destroy (face);
+  }
+
+  hb_ot_var_axis_info_t axes[16];
+  unsigned num_axes = sizeof (axes) / sizeof (axes[0]);
+  hb_ot_var_get_axis_infos (hb_font_get_face (font), 0, &num_axes, axes);
+  assert (num_axes);
+
+  hb_draw_funcs_t *draw_funcs = hb_draw_funcs_create ();
+  hb_draw_funcs_set_move_to_func (draw_funcs, _hb_move_to, nullptr, nullptr);
+  hb_draw_funcs_set_line_to_func (draw_funcs, _hb_line_to, nullptr, nullptr);
+  hb_draw_funcs_set_quadratic_to_func (draw_funcs, _hb_quadratic_to, nullptr, nullptr);
+  hb_draw_funcs_set_cubic_to_func (draw_funcs, _hb_cubic_to, nullptr, nullptr);
+  hb_draw_funcs_set_close_path_func (draw_funcs, _hb_close_path, nullptr, nullptr);
+
+  const unsigned steps = 16;
+  unsigned step = 0;
+  for (auto _ : state)
+  {
+    float coords[16];
+    for (unsigned i = 0; i < num_axes; i++)
+      coords[i] = axes[i].min_value + (axes[i].max_value - axes[i].min_value) * step / (steps - 1);
+    hb_font_set_var_coords_design (font, coords, num_axes);
+    step = (step + 1) % steps;
+
+    for (unsigned gid = 0; gid < num_glyphs; ++gid)
+      hb_font_get_glyph_shape (font, gid, draw_funcs, nullptr);
+  }
+  state.counters["glyphs"] = benchmark::Counter (num_glyphs, benchmark::Counter::kIsIterationInvariantRate);
+
+  hb_draw_funcs_destroy (draw_funcs);
+  hb_font_destroy (font);
+}
+
 #define FONT_BASE_PATH "test/subset/data/fonts/"
 
 BENCHMARK_CAPTURE (draw, cff - ot - SourceSansPro, FONT_BASE_PATH "SourceSansPro-Regular.otf", false, HARFBUZZ);
@@ -175,3 +238,7 @@ BENCHMARK_CAPTURE (draw, glyf/vf - tp - Comfortaa, FONT_BASE_PATH "Comfortaa-Reg
 BENCHMARK_CAPTURE (draw, glyf - ot - Roboto, FONT_BASE_PATH "Roboto-Regular.ttf", false, HARFBUZZ);
 BENCHMARK_CAPTURE (draw, glyf - ft - Roboto, FONT_BASE_PATH "Roboto-Regular.ttf", false, FREETYPE);
 BENCHMARK_CAPTURE (draw, glyf - tp - Roboto, FONT_BASE_PATH "Roboto-Regular.ttf", false, TTF_PARSER);
+
+BENCHMARK_CAPTURE (draw_sweep, glyf/vf - SourceSerifVariable, FONT_BASE_PATH "SourceSerifVariable-Roman.ttf");
+BENCHMARK_CAPTURE (draw_sweep, glyf/vf - Comfortaa, FONT_BASE_PATH "Comfortaa-Regular-new.ttf");
+BENCHMARK_CAPTURE (draw_sweep, cff2/vf - AdobeVFPrototype, FONT_BASE_PATH "AdobeVFPrototype.otf");
@@ -0,0 +1,91 @@
+#ifndef PERF_HEAP_HH
+#define PERF_HEAP_HH
+
+/*
+ * Heap usage is measured by wrapping the allocator; that is only done
+ * with glibc, which exposes the underlying functions to forward to.
+ */
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+#define PERF_HEAP_TRACKING 1
+#include <malloc.h>
+
+extern "C" {
+void *__libc_malloc (size_t size);
+void *__libc_calloc (size_t nmemb, size_t size);
+void *__libc_realloc (void *ptr, size_t size);
+void __libc_free (void *ptr);
+}
+
+static bool heap_tracking;
+static size_t heap_current;
+static size_t heap_peak;
+static size_t heap_allocs;
+
+static void
+_heap_track_alloc (void *p)
+{
+  if (!heap_tracking || !p) return;
+  heap_allocs++;
+  heap_current += malloc_usable_size (p);
+  if (heap_current > heap_peak) heap_peak = heap_current;
+}
+
+static void
+_heap_track_free (void *p)
+{
+  if (!heap_tracking || !p) return;
+  size_t size = malloc_usable_size (p);
+  /* Blocks allocated before tracking started may be freed during it. */
+  heap_current = heap_current > size ? heap_current - size : 0;
+}
+
+extern "C" void *
+malloc (size_t size)
+{
+  void *p = __libc_malloc (size);
+  _heap_track_alloc (p);
+  return p;
+}
+
+extern "C" void *
+calloc (size_t nmemb, size_t size)
+{
+  void *p = __libc_calloc (nmemb, size);
+  _heap_track_alloc (p);
+  return p;
+}
+
+extern "C" void *
+realloc (void *ptr, size_t size)
+{
+  _heap_track_free (ptr);
+  void *p = __libc_realloc (ptr, size);
+  _heap_track_alloc (p ? p : (size ? ptr : nullptr));
+  return p;
+}
+
+extern "C" void
+free (void *ptr)
+{
+  _heap_track_free (ptr);
+  __libc_free (ptr);
+}
+
+static void
+heap_tracking_start ()
+{
+  heap_current = heap_peak = heap_allocs = 0;
+  heap_tracking = true;
+}
+
+/* Returns the peak heap usage since heap_tracking_start(); the number of
+ * allocations made meanwhile is left in heap_allocs. */
+static size_t
+heap_tracking_stop ()
+{
+  heap_tracking = false;
+  return heap_peak;
+}
+#endif
+
+#endif /* PERF_HEAP_HH */
@@ -0,0 +1,94 @@
+#include "benchmark/benchmark.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "hb.h"
+#include "hb-subset.h"
+
+/*
+ * Times subsetting the GSUB/GPOS tables of the fonts used by the repacker
+ * tests in test/subset/data/repack_tests. Those subsets overflow offsets,
+ * so most of the time goes into resolving them.
+ *
+ * A test file is the name of a font in test/subset/data/fonts, followed
+ * by the codepoints to retain, one per line; '*' retains all.
+ */
+static hb_face_t *
+load_repack_test (const char *test_path, hb_subset_input_t *input)
+{
+  FILE *f = fopen (test_path, "r");
+  assert (f);
+
+  char line[256];
+  char font_path[512];
+  if (!fgets (line, sizeof (line), f)) abort ();
+  line[strcspn (line, "\r\n")] = '\0';
+  snprintf (font_path, sizeof (font_path), "test/subset/data/fonts/%s", line);
+
+  hb_set_t *unicodes = hb_subset_input_unicode_set (input);
+  while (fgets (line, sizeof (line), f))
+  {
+    line[strcspn (line, "\r\n")] = '\0';
+    if (!*line) continue;
+    if (*line == '*')
+      hb_set_invert (unicodes);
+    else
+      hb_set_add (unicodes, strtoul (line, nullptr, 16));
+  }
+  fclose (f);
+
+  hb_blob_t *blob = hb_blob_create_from_file_or_fail (font_path);
+  assert (blob);
+  hb_face_t *face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  return face;
+}
+
+static void repack (benchmark::State &state, const char *test_path)
+{
+  hb_subset_input_t *input = hb_subset_input_create_or_fail ();
+  assert (input);
+  hb_face_t *face = load_repack_test (test_path, input);
+
+  /* Only keep the tables that need repacking. */
+  hb_set_t *drop_tables = hb_subset_input_set (input, HB_SUBSET_SETS_DROP_TABLE_TAG);
+  hb_set_clear (drop_tables);
+  hb_set_invert (drop_tables);
+  hb_set_del (drop_tables, HB_TAG ('G','S','U','B'));
+  hb_set_del (drop_tables, HB_TAG ('G','P','O','S'));
+  hb_set_del (drop_tables, HB_TAG ('G','D','E','F'));
+
+  for (auto _ : state)
+  {
+    hb_face_t *subset = hb_subset_or_fail (face, input);
+    assert (subset);
+    hb_face_destroy (subset);
+  }
+
+  hb_face_destroy (face);
+  hb_subset_input_destroy (input);
+}
+
+BENCHMARK_CAPTURE (repack, basic,
+		   "test/subset/data/repack_tests/basic.tests")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE (repack, prioritization,
+		   "test/subset/data/repack_tests/prioritization.tests")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE (repack, advanced_prioritization,
+		   "test/subset/data/repack_tests/advanced_prioritization.tests")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE (repack, table_duplication,
+		   "test/subset/data/repack_tests/table_duplication.tests")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE (repack, isolation,
+		   "test/subset/data/repack_tests/isolation.tests")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE (repack, space_splitting,
+		   "test/subset/data/repack_tests/space_splitting.tests")
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN ();
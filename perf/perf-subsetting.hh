@@ -0,0 +1,116 @@
+#include "benchmark/benchmark.h"
+
+#include <cassert>
+
+#include "hb.h"
+#include "hb-subset.h"
+
+#include "perf-heap.hh"
+
+enum subset_operation_t { PLAN_CREATE, PLAN_EXECUTE };
+
+static hb_subset_input_t *
+_subset_input (hb_face_t *face, unsigned num_unicodes, bool retain_gids)
+{
+  hb_subset_input_t *input = hb_subset_input_create_or_fail ();
+  assert (input);
+
+  hb_set_t *all_unicodes = hb_set_create ();
+  hb_face_collect_unicodes (face, all_unicodes);
+
+  hb_set_t *unicodes = hb_subset_input_unicode_set (input);
+  for (hb_codepoint_t u = HB_SET_VALUE_INVALID;
+       hb_set_next (all_unicodes, &u) && hb_set_get_population (unicodes) < num_unicodes;)
+    hb_set_add (unicodes, u);
+  hb_set_destroy (all_unicodes);
+
+  if (retain_gids)
+    hb_subset_input_set_flags (input, HB_SUBSET_FLAGS_RETAIN_GIDS);
+
+  return input;
+}
+
+/*
+ * state.range (0) is the number of unicodes to retain, taken in order from
+ * the font's cmap; state.range (1) is whether to retain glyph ids.
+ */
+static void subset (benchmark::State &state, const char *font_path,
+		    subset_operation_t operation)
+{
+  hb_face_t *face;
+  {
+    hb_blob_t *blob = hb_blob_create_from_file_or_fail (font_path);
+    assert (blob);
+    face = hb_face_create (blob, 0);
+    hb_blob_destroy (blob);
+  }
+
+  hb_subset_input_t *input = _subset_input (face, state.range (0), state.range (1));
+
+  /* Warm up the face's lazily loaded tables. */
+  hb_face_destroy (hb_subset_or_fail (face, input));
+
+#ifdef PERF_HEAP_TRACKING
+  {
+    heap_tracking_start ();
+    hb_subset_plan_t *plan = hb_subset_plan_create_or_fail (face, input);
+    size_t create_peak = heap_peak;
+    /* Execute is measured on top of the memory the plan holds. */
+    heap_current = heap_peak = 0;
+    hb_face_destroy (hb_subset_plan_execute_or_fail (plan));
+    size_t execute_peak = heap_tracking_stop ();
+    hb_subset_plan_destroy (plan);
+
+    state.counters["peak_heap"] = benchmark::Counter (operation == PLAN_CREATE ? create_peak : execute_peak,
+						      benchmark::Counter::kDefaults,
+						      benchmark::Counter::OneK::kIs1024);
+  }
+#endif
+
+  if (operation == PLAN_CREATE)
+  {
+    for (auto _ : state)
+    {
+      hb_subset_plan_t *plan = hb_subset_plan_create_or_fail (face, input);
+      assert (plan);
+      hb_subset_plan_destroy (plan);
+    }
+  }
+  else
+  {
+    hb_subset_plan_t *plan = hb_subset_plan_create_or_fail (face, input);
+    assert (plan);
+    for (auto _ : state)
+    {
+      hb_face_t *subset = hb_subset_plan_execute_or_fail (plan);
+      assert (subset);
+      hb_face_destroy (subset);
+    }
+    hb_subset_plan_destroy (plan);
+  }
+
+  hb_subset_input_destroy (input);
+  hb_face_destroy (face);
+}
+
+/* Small, medium and large unicode sets, without and with retain-gids. */
+static void subset_args (benchmark::internal::Benchmark *b)
+{
+  b->ArgNames ({"unicodes", "retain_gids"});
+  for (int retain_gids = 0; retain_gids <= 1; retain_gids++)
+    for (int num_unicodes : {10, 100, 1000})
+      b->Args ({num_unicodes, retain_gids});
+  b->Unit (benchmark::kMicrosecond);
+}
+
+BENCHMARK_CAPTURE (subset, plan_create - glyf - Roboto, "perf/fonts/Roboto-Regular.ttf", PLAN_CREATE)->Apply (subset_args);
+BENCHMARK_CAPTURE (subset, plan_execute - glyf - Roboto, "perf/fonts/Roboto-Regular.ttf", PLAN_EXECUTE)->Apply (subset_args);
+
+BENCHMARK_CAPTURE (subset, plan_create - glyf/vf - SourceSerifVariable, "test/subset/data/fonts/SourceSerifVariable-Roman.ttf", PLAN_CREATE)->Apply (subset_args);
+BENCHMARK_CAPTURE (subset, plan_execute - glyf/vf - SourceSerifVariable, "test/subset/data/fonts/SourceSerifVariable-Roman.ttf", PLAN_EXECUTE)->Apply (subset_args);
+
+BENCHMARK_CAPTURE (subset, plan_create - cff - SourceSansPro, "test/subset/data/fonts/SourceSansPro-Regular.otf", PLAN_CREATE)->Apply (subset_args);
+BENCHMARK_CAPTURE (subset, plan_execute - cff - SourceSansPro, "test/subset/data/fonts/SourceSansPro-Regular.otf", PLAN_EXECUTE)->Apply (subset_args);
+
+BENCHMARK_CAPTURE (subset, plan_create - cff2/vf - AdobeVFPrototype, "test/subset/data/fonts/AdobeVFPrototype.otf", PLAN_CREATE)->Apply (subset_args);
+BENCHMARK_CAPTURE (subset, plan_execute - cff2/vf - AdobeVFPrototype, "test/subset/data/fonts/AdobeVFPrototype.otf", PLAN_EXECUTE)->Apply (subset_args);
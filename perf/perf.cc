@@ -5,6 +5,7 @@
 #endif
 
 #include "perf-shaping.hh"
+#include "perf-subsetting.hh"
 #ifdef HAVE_FREETYPE
 enum backend_t { HARFBUZZ, FREETYPE, TTF_PARSER };
 #include "perf-extents.hh"
@@ -57,6 +57,14 @@ struct LookupFormat0
     return &arrayZ[glyph_id];
   }
 
+  template <typename set_t, typename filter_t>
+  void collect_glyphs_filtered (set_t &glyphs, unsigned num_glyphs, const filter_t &filter) const
+  {
+    for (unsigned i = 0; i < num_glyphs; i++)
+      if (filter (arrayZ[i]))
+	glyphs.add (i);
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -115,6 +123,18 @@ struct LookupFormat2
     return v ? &v->value : nullptr;
   }
 
+  template <typename set_t, typename filter_t>
+  void collect_glyphs_filtered (set_t &glyphs, const filter_t &filter) const
+  {
+    unsigned count = segments.get_length ();
+    for (unsigned i = 0; i < count; i++)
+    {
+      const LookupSegmentSingle<T> &segment = segments[i];
+      if (filter (segment.value))
+	glyphs.add_range (segment.first, segment.last);
+    }
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -186,6 +206,20 @@ struct LookupFormat4
     return v ? v->get_value (glyph_id, this) : nullptr;
   }
 
+  template <typename set_t, typename filter_t>
+  void collect_glyphs_filtered (set_t &glyphs, const filter_t &filter) const
+  {
+    unsigned count = segments.get_length ();
+    for (unsigned i = 0; i < count; i++)
+    {
+      const LookupSegmentArray<T> &segment = segments[i];
+      const UnsizedArrayOf<T> &values = this+segment.valuesZ;
+      for (unsigned g = segment.first; g <= segment.last; g++)
+	if (filter (values[g - segment.first]))
+	  glyphs.add (g);
+    }
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -243,6 +277,18 @@ struct LookupFormat6
     return v ? &v->value : nullptr;
   }
 
+  template <typename set_t, typename filter_t>
+  void collect_glyphs_filtered (set_t &glyphs, const filter_t &filter) const
+  {
+    unsigned count = entries.get_length ();
+    for (unsigned i = 0; i < count; i++)
+    {
+      const LookupSingle<T> &entry = entries[i];
+      if (filter (entry.value))
+	glyphs.add (entry.glyph);
+    }
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -274,6 +320,15 @@ struct LookupFormat8
 	   &valueArrayZ[glyph_id - firstGlyph] : nullptr;
   }
 
+  template <typename set_t, typename filter_t>
+  void collect_glyphs_filtered (set_t &glyphs, const filter_t &filter) const
+  {
+    unsigned count = glyphCount;
+    for (unsigned i = 0; i < count; i++)
+      if (filter (valueArrayZ[i]))
+	glyphs.add (firstGlyph + i);
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -373,6 +428,21 @@ struct Lookup
     return v ? *v : outOfRange;
   }
 
+  /* Adds the glyphs get_value() may return a value passing filter for.
+   * Format 10 is skipped, as get_value() does not support it either. */
+  template <typename set_t, typename filter_t>
+  void collect_glyphs_filtered (set_t &glyphs, unsigned num_glyphs, const filter_t &filter) const
+  {
+    switch (u.format) {
+    case 0: u.format0.collect_glyphs_filtered (glyphs, num_glyphs, filter); return;
+    case 2: u.format2.collect_glyphs_filtered (glyphs, filter); return;
+    case 4: u.format4.collect_glyphs_filtered (glyphs, filter); return;
+    case 6: u.format6.collect_glyphs_filtered (glyphs, filter); return;
+    case 8: u.format8.collect_glyphs_filtered (glyphs, filter); return;
+    default:return;
+    }
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -507,6 +577,33 @@ struct StateTable
     return (this+classTable).get_class (glyph_id, num_glyphs, 1);
   }
 
+  unsigned int get_num_classes () const { return nClasses; }
+
+  /* Adds the glyphs that do not classify as CLASS_OUT_OF_BOUNDS. */
+  template <typename set_t>
+  void collect_glyphs (set_t &glyphs, unsigned int num_glyphs) const
+  {
+    unsigned int num_classes = nClasses;
+    (this+classTable).collect_glyphs_filtered (glyphs, num_glyphs,
+					       [=] (unsigned int klass)
+					       { return klass != CLASS_OUT_OF_BOUNDS && klass < num_classes; });
+    glyphs.add (DELETED_GLYPH);
+  }
+
+  /* Whether a run of CLASS_OUT_OF_BOUNDS glyphs goes through the machine
+   * untouched: the start state loops on them without acting or holding
+   * the glyph pointer, and ending the text there does not act either. */
+  template <typename actionable_t>
+  bool ignores_out_of_bounds (const actionable_t &is_actionable,
+			      unsigned int dont_advance_flag) const
+  {
+    const Entry<Extra> &entry = get_entry (STATE_START_OF_TEXT, CLASS_OUT_OF_BOUNDS);
+    return new_state (entry.newState) == STATE_START_OF_TEXT &&
+	   !(entry.flags & dont_advance_flag) &&
+	   !is_actionable (entry) &&
+	   !is_actionable (get_entry (STATE_START_OF_TEXT, CLASS_END_OF_TEXT));
+  }
+
   const Entry<Extra> *get_entries () const
   { return (this+entryTable).arrayZ; }
 
@@ -730,6 +827,161 @@ struct ExtendedTypes
   }
 };
 
+/*
+ * Class cache
+ */
+
+#ifndef HB_AAT_CLASS_CACHE_MAX_BYTES
+#define HB_AAT_CLASS_CACHE_MAX_BYTES (1u << 20)
+#endif
+
+/* Classes of glyphs 0..length-1 in one state table, clamped to the
+ * table's class count the way StateTable::get_entry() clamps them. */
+struct hb_aat_class_array_t
+{
+  unsigned int get (hb_codepoint_t glyph_id) const
+  {
+    return wide ? ((const uint16_t *) (this + 1))[glyph_id]
+		: ((const uint8_t *) (this + 1))[glyph_id];
+  }
+
+  template <typename StateTableT>
+  static hb_aat_class_array_t *create (const StateTableT &machine,
+				       unsigned int num_glyphs,
+				       bool wide)
+  {
+    hb_aat_class_array_t *array = (hb_aat_class_array_t *)
+				  hb_malloc (sizeof (hb_aat_class_array_t) + (num_glyphs << wide));
+    if (unlikely (!array)) return nullptr;
+    array->length = num_glyphs;
+    array->wide = wide;
+
+    unsigned int num_classes = machine.get_num_classes ();
+    uint8_t *classes8 = (uint8_t *) (array + 1);
+    uint16_t *classes16 = (uint16_t *) (array + 1);
+    for (unsigned int i = 0; i < num_glyphs; i++)
+    {
+      unsigned int klass = machine.get_class (i, num_glyphs);
+      if (unlikely (klass >= num_classes))
+	klass = StateTableT::CLASS_OUT_OF_BOUNDS;
+      if (wide)
+	classes16[i] = klass;
+      else
+	classes8[i] = klass;
+    }
+    return array;
+  }
+
+  unsigned int length;
+  bool wide;
+  /* uint8_t or uint16_t classes follow. */
+};
+
+/* Class arrays for the state-table subtables of a morx or kerx table,
+ * indexed by subtable index in table order.  Each array is built the
+ * first time its subtable is applied; once the table's arrays take
+ * HB_AAT_CLASS_CACHE_MAX_BYTES, remaining subtables get the Null array,
+ * which covers no glyphs, and keep using their class lookup. */
+struct hb_aat_class_cache_t
+{
+  void init (unsigned int num_subtables_)
+  {
+    lock.init ();
+    used_bytes = 0;
+    arrays = (hb_atomic_ptr_t<const hb_aat_class_array_t> *) hb_calloc (num_subtables_, sizeof (arrays[0]));
+    num_subtables = likely (arrays) ? num_subtables_ : 0;
+  }
+
+  void fini ()
+  {
+    for (unsigned int i = 0; i < num_subtables; i++)
+    {
+      const hb_aat_class_array_t *array = arrays[i].get_relaxed ();
+      if (array != &Null (hb_aat_class_array_t))
+	hb_free ((void *) array);
+    }
+    hb_free (arrays);
+    lock.fini ();
+  }
+
+  template <typename StateTableT>
+  const hb_aat_class_array_t *get (unsigned int subtable_index,
+				   const StateTableT &machine,
+				   unsigned int num_glyphs) const
+  {
+    if (unlikely (subtable_index >= num_subtables))
+      return &Null (hb_aat_class_array_t);
+
+    const hb_aat_class_array_t *array = arrays[subtable_index].get ();
+    if (likely (array)) return array;
+
+    hb_lock_t l (lock);
+    array = arrays[subtable_index].get ();
+    if (array) return array;
+
+    bool wide = machine.get_num_classes () > 0x100u;
+    unsigned int size = num_glyphs << wide;
+    hb_aat_class_array_t *created = nullptr;
+    if (used_bytes + size <= HB_AAT_CLASS_CACHE_MAX_BYTES)
+      created = hb_aat_class_array_t::create (machine, num_glyphs, wide);
+    if (created)
+      used_bytes += size;
+    array = created ? created : &Null (hb_aat_class_array_t);
+    arrays[subtable_index].cmpexch (nullptr, const_cast<hb_aat_class_array_t *> (array));
+    return array;
+  }
+
+  private:
+  mutable hb_mutex_t lock;
+  mutable unsigned int used_bytes;
+  hb_atomic_ptr_t<const hb_aat_class_array_t> *arrays;
+  unsigned int num_subtables;
+};
+
+
+struct ankr;
+
+struct hb_aat_apply_context_t :
+       hb_dispatch_context_t<hb_aat_apply_context_t, bool, HB_DEBUG_APPLY>
+{
+  const char *get_name () { return "APPLY"; }
+  template <typename T>
+  return_t dispatch (const T &obj) { return obj.apply (this); }
+  static return_t default_return_value () { return false; }
+  bool stop_sublookup_iteration (return_t r) const { return r; }
+
+  const hb_ot_shape_plan_t *plan;
+  hb_font_t *font;
+  hb_face_t *face;
+  hb_buffer_t *buffer;
+  hb_sanitize_context_t sanitizer;
+  const ankr *ankr_table;
+  const OT::GDEF *gdef_table;
+  const hb_aat_class_cache_t *class_cache;
+  /* Glyphs each subtable may act on, and the glyphs in the buffer. */
+  hb_array_t<const hb_set_digest_t> subtable_digests;
+  hb_set_digest_t buffer_digest;
+
+  /* Index of the subtable being applied; keys class_cache. */
+  unsigned int lookup_index;
+
+  HB_INTERNAL hb_aat_apply_context_t (const hb_ot_shape_plan_t *plan_,
+				      hb_font_t *font_,
+				      hb_buffer_t *buffer_,
+				      hb_blob_t *blob = const_cast<hb_blob_t *> (&Null (hb_blob_t)));
+
+  HB_INTERNAL ~hb_aat_apply_context_t ();
+
+  HB_INTERNAL void set_ankr_table (const AAT::ankr *ankr_table_);
+
+  void set_class_cache (const hb_aat_class_cache_t *class_cache_) { class_cache = class_cache_; }
+  void set_subtable_digests (hb_array_t<const hb_set_digest_t> subtable_digests_) { subtable_digests = subtable_digests_; }
+
+  void set_lookup_index (unsigned int i) { lookup_index = i; }
+};
+
+
+
 template <typename Types, typename EntryData>
 struct StateTableDriver
 {
@@ -737,11 +989,20 @@ struct StateTableDriver
   using EntryT = Entry<EntryData>;
 
   StateTableDriver (const StateTableT &machine_,
-		    hb_buffer_t *buffer_,
-		    hb_face_t *face_) :
+		    hb_aat_apply_context_t *c) :
 	      machine (machine_),
-	      buffer (buffer_),
-	      num_glyphs (face_->get_num_glyphs ()) {}
+	      buffer (c->buffer),
+	      num_glyphs (c->face->get_num_glyphs ()),
+	      classes (c->class_cache ?
+		       c->class_cache->get (c->lookup_index, machine_, num_glyphs) :
+		       &Null (hb_aat_class_array_t)) {}
+
+  unsigned int get_class (hb_codepoint_t glyph_id) const
+  {
+    if (likely (glyph_id < classes->length))
+      return classes->get (glyph_id);
+    return machine.get_class (glyph_id, num_glyphs);
+  }
 
   template <typename context_t>
   void drive (context_t *c)
@@ -753,7 +1014,7 @@ struct StateTableDriver
     for (buffer->idx = 0; buffer->successful;)
     {
       unsigned int klass = buffer->idx < buffer->len ?
-			   machine.get_class (buffer->info[buffer->idx].codepoint, num_glyphs) :
+			   get_class (buffer->info[buffer->idx].codepoint) :
 			   (unsigned) StateTableT::CLASS_END_OF_TEXT;
       DEBUG_MSG (APPLY, nullptr, "c%u at %u", klass, buffer->idx);
       const EntryT &entry = machine.get_entry (state, klass);
@@ -846,41 +1107,7 @@ struct StateTableDriver
   const StateTableT &machine;
   hb_buffer_t *buffer;
   unsigned int num_glyphs;
-};
-
-
-struct ankr;
-
-struct hb_aat_apply_context_t :
-       hb_dispatch_context_t<hb_aat_apply_context_t, bool, HB_DEBUG_APPLY>
-{
-  const char *get_name () { return "APPLY"; }
-  template <typename T>
-  return_t dispatch (const T &obj) { return obj.apply (this); }
-  static return_t default_return_value () { return false; }
-  bool stop_sublookup_iteration (return_t r) const { return r; }
-
-  const hb_ot_shape_plan_t *plan;
-  hb_font_t *font;
-  hb_face_t *face;
-  hb_buffer_t *buffer;
-  hb_sanitize_context_t sanitizer;
-  const ankr *ankr_table;
-  const OT::GDEF *gdef_table;
-
-  /* Unused. For debug tracing only. */
-  unsigned int lookup_index;
-
-  HB_INTERNAL hb_aat_apply_context_t (const hb_ot_shape_plan_t *plan_,
-				      hb_font_t *font_,
-				      hb_buffer_t *buffer_,
-				      hb_blob_t *blob = const_cast<hb_blob_t *> (&Null (hb_blob_t)));
-
-  HB_INTERNAL ~hb_aat_apply_context_t ();
-
-  HB_INTERNAL void set_ankr_table (const AAT::ankr *ankr_table_);
-
-  void set_lookup_index (unsigned int i) { lookup_index = i; }
+  const hb_aat_class_array_t *classes;
 };
 
 
@@ -67,6 +67,7 @@ struct hb_glyph_pair_t
 struct KernPair
 {
   int get_kerning () const { return value; }
+  hb_codepoint_t get_left () const { return left; }
 
   int cmp (const hb_glyph_pair_t &o) const
   {
@@ -130,6 +131,12 @@ struct KerxSubTableFormat0
     { return table.get_kerning (left, right, c); }
   };
 
+  /* A pair only kerns with its left glyph in the buffer. */
+  void collect_coverage (hb_set_digest_t *digest, unsigned int num_glyphs HB_UNUSED) const
+  {
+    for (const KernPair &pair : pairs.as_array ())
+      digest->add (pair.get_left ());
+  }
 
   bool sanitize (hb_sanitize_context_t *c) const
   {
@@ -349,12 +356,22 @@ struct KerxSubTableFormat1
 
     driver_context_t dc (this, c);
 
-    StateTableDriver<Types, EntryData> driver (machine, c->buffer, c->font->face);
+    StateTableDriver<Types, EntryData> driver (machine, c);
     driver.drive (&dc);
 
     return_trace (true);
   }
 
+  void collect_coverage (hb_set_digest_t *digest, unsigned int num_glyphs) const
+  {
+    if (machine.ignores_out_of_bounds ([] (const Entry<EntryData> &entry)
+				       { return Format1EntryT::performAction (entry); },
+				       driver_context_t::DontAdvance))
+      machine.collect_glyphs (*digest, num_glyphs);
+    else
+      digest->add_range (0, HB_SET_VALUE_INVALID - 1);
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -593,12 +610,22 @@ struct KerxSubTableFormat4
 
     driver_context_t dc (this, c);
 
-    StateTableDriver<Types, EntryData> driver (machine, c->buffer, c->font->face);
+    StateTableDriver<Types, EntryData> driver (machine, c);
     driver.drive (&dc);
 
     return_trace (true);
   }
 
+  void collect_coverage (hb_set_digest_t *digest, unsigned int num_glyphs) const
+  {
+    if (machine.ignores_out_of_bounds ([] (const Entry<EntryData> &entry)
+				       { return entry.data.ankrActionIndex != 0xFFFF; },
+				       driver_context_t::DontAdvance))
+      machine.collect_glyphs (*digest, num_glyphs);
+    else
+      digest->add_range (0, HB_SET_VALUE_INVALID - 1);
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -784,6 +811,21 @@ struct KerxSubTable
     }
   }
 
+  /* Adds the glyphs this subtable may kern; a buffer without any of
+   * them goes through it untouched.  The class-based formats 2 and 6
+   * look glyphs missing from their class tables up in the first row
+   * or column, which fonts are free to fill in, so they cover every
+   * glyph. */
+  void collect_coverage (hb_set_digest_t *digest, unsigned int num_glyphs) const
+  {
+    switch (get_type ()) {
+    case 0:	u.format0.collect_coverage (digest, num_glyphs); return;
+    case 1:	u.format1.collect_coverage (digest, num_glyphs); return;
+    case 4:	u.format4.collect_coverage (digest, num_glyphs); return;
+    default:	digest->add_range (0, HB_SET_VALUE_INVALID - 1); return;
+    }
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -874,6 +916,9 @@ struct KerxTable
     bool ret = false;
     bool seenCrossStream = false;
     c->set_lookup_index (0);
+    /* Kerning does not change the glyphs, so one digest does. */
+    if (c->subtable_digests)
+      c->buffer_digest = c->buffer->digest ();
     const SubTable *st = &thiz()->firstSubTable;
     unsigned int count = thiz()->tableCount;
     for (unsigned int i = 0; i < count; i++)
@@ -889,6 +934,16 @@ struct KerxTable
       reverse = bool (st->u.header.coverage & st->u.header.Backwards) !=
 		HB_DIRECTION_IS_BACKWARD (c->buffer->props.direction);
 
+      /* The first cross-stream subtable chains all glyphs together below,
+       * whether it kerns anything or not, so it always runs. */
+      if (c->lookup_index < c->subtable_digests.length &&
+	  !c->subtable_digests[c->lookup_index].may_have (c->buffer_digest) &&
+	  (seenCrossStream || !(st->u.header.coverage & st->u.header.CrossStream)))
+      {
+	(void) c->buffer->message (c->font, "skipped subtable %d because no glyph matches", c->lookup_index);
+	goto skip;
+      }
+
       if (!c->buffer->message (c->font, "start subtable %d", c->lookup_index))
 	goto skip;
 
@@ -979,6 +1034,43 @@ struct kerx : KerxTable<kerx>
 
   bool has_data () const { return version; }
 
+  struct accelerator_t
+  {
+    accelerator_t (hb_face_t *face)
+    {
+      table = hb_sanitize_context_t ().reference_table<kerx> (face);
+      class_cache.init (table->tableCount);
+      table->collect_subtable_coverage (subtable_digests, face->get_num_glyphs ());
+      if (unlikely (subtable_digests.in_error ()))
+	subtable_digests.fini ();
+    }
+    ~accelerator_t ()
+    {
+      subtable_digests.fini ();
+      class_cache.fini ();
+      table.destroy ();
+    }
+
+    hb_blob_ptr_t<kerx> table;
+    hb_aat_class_cache_t class_cache;
+    /* Glyphs each subtable may kern, in subtable order. */
+    hb_vector_t<hb_set_digest_t> subtable_digests;
+  };
+
+  void collect_subtable_coverage (hb_vector_t<hb_set_digest_t> &digests,
+				  unsigned int num_glyphs) const
+  {
+    const SubTable *st = &firstSubTable;
+    unsigned int count = tableCount;
+    for (unsigned int i = 0; i < count; i++)
+    {
+      hb_set_digest_t *digest = digests.push ();
+      digest->init ();
+      st->collect_coverage (digest, num_glyphs);
+      st = &StructAfter<SubTable> (*st);
+    }
+  }
+
   protected:
   HBUINT16	version;	/* The version number of the extended kerning table
 				 * (currently 2, 3, or 4). */
@@ -992,6 +1084,10 @@ struct kerx : KerxTable<kerx>
   DEFINE_SIZE_MIN (8);
 };
 
+struct kerx_accelerator_t : kerx::accelerator_t {
+  kerx_accelerator_t (hb_face_t *face) : kerx::accelerator_t (face) {}
+};
+
 
 } /* namespace AAT */
 
@@ -168,12 +168,22 @@ struct RearrangementSubtable
 
     driver_context_t dc (this);
 
-    StateTableDriver<Types, EntryData> driver (machine, c->buffer, c->face);
+    StateTableDriver<Types, EntryData> driver (machine, c);
     driver.drive (&dc);
 
     return_trace (dc.ret);
   }
 
+  void collect_coverage (hb_set_digest_t *digest, unsigned int num_glyphs) const
+  {
+    if (machine.ignores_out_of_bounds ([] (const Entry<EntryData> &entry)
+				       { return entry.flags & driver_context_t::Verb; },
+				       driver_context_t::DontAdvance))
+      machine.collect_glyphs (*digest, num_glyphs);
+    else
+      digest->add_range (0, HB_SET_VALUE_INVALID - 1);
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -324,12 +334,22 @@ struct ContextualSubtable
 
     driver_context_t dc (this, c);
 
-    StateTableDriver<Types, EntryData> driver (machine, c->buffer, c->face);
+    StateTableDriver<Types, EntryData> driver (machine, c);
     driver.drive (&dc);
 
     return_trace (dc.ret);
   }
 
+  void collect_coverage (hb_set_digest_t *digest, unsigned int num_glyphs) const
+  {
+    if (machine.ignores_out_of_bounds ([] (const Entry<EntryData> &entry)
+				       { return entry.data.markIndex != 0xFFFF || entry.data.currentIndex != 0xFFFF; },
+				       driver_context_t::DontAdvance))
+      machine.collect_glyphs (*digest, num_glyphs);
+    else
+      digest->add_range (0, HB_SET_VALUE_INVALID - 1);
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -576,12 +596,22 @@ struct LigatureSubtable
 
     driver_context_t dc (this, c);
 
-    StateTableDriver<Types, EntryData> driver (machine, c->buffer, c->face);
+    StateTableDriver<Types, EntryData> driver (machine, c);
     driver.drive (&dc);
 
     return_trace (dc.ret);
   }
 
+  void collect_coverage (hb_set_digest_t *digest, unsigned int num_glyphs) const
+  {
+    if (machine.ignores_out_of_bounds ([] (const Entry<EntryData> &entry)
+				       { return LigatureEntryT::performAction (entry); },
+				       driver_context_t::DontAdvance))
+      machine.collect_glyphs (*digest, num_glyphs);
+    else
+      digest->add_range (0, HB_SET_VALUE_INVALID - 1);
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -634,6 +664,12 @@ struct NoncontextualSubtable
     return_trace (ret);
   }
 
+  void collect_coverage (hb_set_digest_t *digest, unsigned int num_glyphs) const
+  {
+    substitute.collect_glyphs_filtered (*digest, num_glyphs,
+					[] (hb_codepoint_t glyph HB_UNUSED) { return true; });
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -819,12 +855,27 @@ struct InsertionSubtable
 
     driver_context_t dc (this, c);
 
-    StateTableDriver<Types, EntryData> driver (machine, c->buffer, c->face);
+    StateTableDriver<Types, EntryData> driver (machine, c);
     driver.drive (&dc);
 
     return_trace (dc.ret);
   }
 
+  void collect_coverage (hb_set_digest_t *digest, unsigned int num_glyphs) const
+  {
+    if (machine.ignores_out_of_bounds ([] (const Entry<EntryData> &entry)
+				       {
+					 return (entry.flags & (driver_context_t::CurrentInsertCount |
+								driver_context_t::MarkedInsertCount)) &&
+						(entry.data.currentInsertIndex != 0xFFFF ||
+						 entry.data.markedInsertIndex != 0xFFFF);
+				       },
+				       driver_context_t::DontAdvance))
+      machine.collect_glyphs (*digest, num_glyphs);
+    else
+      digest->add_range (0, HB_SET_VALUE_INVALID - 1);
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -922,6 +973,20 @@ struct ChainSubtable
     return_trace (dispatch (c));
   }
 
+  /* Adds the glyphs this subtable may act on; a buffer without any of
+   * them goes through it unchanged. */
+  void collect_coverage (hb_set_digest_t *digest, unsigned int num_glyphs) const
+  {
+    switch (get_type ()) {
+    case Rearrangement:		u.rearrangement.collect_coverage (digest, num_glyphs); return;
+    case Contextual:		u.contextual.collect_coverage (digest, num_glyphs); return;
+    case Ligature:		u.ligature.collect_coverage (digest, num_glyphs); return;
+    case Noncontextual:		u.noncontextual.collect_coverage (digest, num_glyphs); return;
+    case Insertion:		u.insertion.collect_coverage (digest, num_glyphs); return;
+    default:			return;
+    }
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -1002,6 +1067,13 @@ struct Chain
 	  bool (subtable->get_coverage() & ChainSubtable<Types>::Vertical))
 	goto skip;
 
+      if (c->lookup_index < c->subtable_digests.length &&
+	  !c->subtable_digests[c->lookup_index].may_have (c->buffer_digest))
+      {
+	(void) c->buffer->message (c->font, "skipped chainsubtable %d because no glyph matches", c->lookup_index);
+	goto skip;
+      }
+
       /* Buffer contents is always in logical direction.  Determine if
        * we need to reverse before applying this subtable.  We reverse
        * back after if we did reverse indeed.
@@ -1041,6 +1113,8 @@ struct Chain
 	_hb_ot_layout_reverse_graphemes (c->buffer);
 
       subtable->apply (c);
+      if (c->subtable_digests)
+	c->buffer_digest = c->buffer->digest ();
 
       if (reverse)
 	_hb_ot_layout_reverse_graphemes (c->buffer);
@@ -1056,6 +1130,21 @@ struct Chain
   }
 
   unsigned int get_size () const { return length; }
+  unsigned int get_subtable_count () const { return subtableCount; }
+
+  void collect_subtable_coverage (hb_vector_t<hb_set_digest_t> &digests,
+				  unsigned int num_glyphs) const
+  {
+    const ChainSubtable<Types> *subtable = &StructAfter<ChainSubtable<Types>> (featureZ.as_array (featureCount));
+    unsigned int count = subtableCount;
+    for (unsigned int i = 0; i < count; i++)
+    {
+      hb_set_digest_t *digest = digests.push ();
+      digest->init ();
+      subtable->collect_coverage (digest, num_glyphs);
+      subtable = &StructAfter<ChainSubtable<Types>> (*subtable);
+    }
+  }
 
   bool sanitize (hb_sanitize_context_t *c, unsigned int version HB_UNUSED) const
   {
@@ -1106,6 +1195,31 @@ struct mortmorx
 
   bool has_data () const { return version != 0; }
 
+  unsigned int get_subtable_count () const
+  {
+    unsigned int num_subtables = 0;
+    const Chain<Types> *chain = &firstChain;
+    unsigned int count = chainCount;
+    for (unsigned int i = 0; i < count; i++)
+    {
+      num_subtables += chain->get_subtable_count ();
+      chain = &StructAfter<Chain<Types>> (*chain);
+    }
+    return num_subtables;
+  }
+
+  void collect_subtable_coverage (hb_vector_t<hb_set_digest_t> &digests,
+				  unsigned int num_glyphs) const
+  {
+    const Chain<Types> *chain = &firstChain;
+    unsigned int count = chainCount;
+    for (unsigned int i = 0; i < count; i++)
+    {
+      chain->collect_subtable_coverage (digests, num_glyphs);
+      chain = &StructAfter<Chain<Types>> (*chain);
+    }
+  }
+
   void compile_flags (const hb_aat_map_builder_t *mapper,
 		      hb_aat_map_t *map) const
   {
@@ -1122,6 +1236,8 @@ struct mortmorx
   {
     if (unlikely (!c->buffer->successful)) return;
     c->set_lookup_index (0);
+    if (c->subtable_digests)
+      c->buffer_digest = c->buffer->digest ();
     const Chain<Types> *chain = &firstChain;
     unsigned int count = chainCount;
     for (unsigned int i = 0; i < count; i++)
@@ -1162,9 +1278,37 @@ struct mortmorx
   DEFINE_SIZE_MIN (8);
 };
 
-struct morx : mortmorx<ExtendedTypes, HB_AAT_TAG_morx> {};
+struct morx : mortmorx<ExtendedTypes, HB_AAT_TAG_morx>
+{
+  struct accelerator_t
+  {
+    accelerator_t (hb_face_t *face)
+    {
+      table = hb_sanitize_context_t ().reference_table<morx> (face);
+      class_cache.init (table->get_subtable_count ());
+      table->collect_subtable_coverage (subtable_digests, face->get_num_glyphs ());
+      if (unlikely (subtable_digests.in_error ()))
+	subtable_digests.fini ();
+    }
+    ~accelerator_t ()
+    {
+      subtable_digests.fini ();
+      class_cache.fini ();
+      table.destroy ();
+    }
+
+    hb_blob_ptr_t<morx> table;
+    hb_aat_class_cache_t class_cache;
+    /* Glyphs each subtable may act on, in subtable order. */
+    hb_vector_t<hb_set_digest_t> subtable_digests;
+  };
+};
 struct mort : mortmorx<ObsoleteTypes, HB_AAT_TAG_mort> {};
 
+struct morx_accelerator_t : morx::accelerator_t {
+  morx_accelerator_t (hb_face_t *face) : morx::accelerator_t (face) {}
+};
+
 
 } /* namespace AAT */
 
@@ -56,8 +56,10 @@ AAT::hb_aat_apply_context_t::hb_aat_apply_context_t (const hb_ot_shape_plan_t *p
 						       sanitizer (),
 						       ankr_table (&Null (AAT::ankr)),
 						       gdef_table (face->table.GDEF->table),
+						       class_cache (nullptr),
 						       lookup_index (0)
 {
+  buffer_digest.init ();
   sanitizer.init (blob);
   sanitizer.set_num_glyphs (face->get_num_glyphs ());
   sanitizer.start_processing ();
@@ -203,7 +205,7 @@ void
 hb_aat_layout_compile_map (const hb_aat_map_builder_t *mapper,
 			   hb_aat_map_t *map)
 {
-  const AAT::morx& morx = *mapper->face->table.morx;
+  const AAT::morx& morx = *mapper->face->table.morx->table;
   if (morx.has_data ())
   {
     morx.compile_flags (mapper, map);
@@ -235,7 +237,7 @@ hb_aat_layout_compile_map (const hb_aat_map_builder_t *mapper,
 hb_bool_t
 hb_aat_layout_has_substitution (hb_face_t *face)
 {
-  return face->table.morx->has_data () ||
+  return face->table.morx->table->has_data () ||
 	 face->table.mort->has_data ();
 }
 
@@ -244,11 +246,14 @@ hb_aat_layout_substitute (const hb_ot_shape_plan_t *plan,
 			  hb_font_t *font,
 			  hb_buffer_t *buffer)
 {
-  hb_blob_t *morx_blob = font->face->table.morx.get_blob ();
+  const AAT::morx_accelerator_t &morx_accel = *font->face->table.morx;
+  hb_blob_t *morx_blob = morx_accel.table.get_blob ();
   const AAT::morx& morx = *morx_blob->as<AAT::morx> ();
   if (morx.has_data ())
   {
     AAT::hb_aat_apply_context_t c (plan, font, buffer, morx_blob);
+    c.set_class_cache (&morx_accel.class_cache);
+    c.set_subtable_digests (morx_accel.subtable_digests);
     if (!buffer->message (font, "start table morx")) return;
     morx.apply (&c);
     (void) buffer->message (font, "end table morx");
@@ -306,7 +311,7 @@ hb_aat_layout_remove_deleted_glyphs (hb_buffer_t *buffer)
 hb_bool_t
 hb_aat_layout_has_positioning (hb_face_t *face)
 {
-  return face->table.kerx->has_data ();
+  return face->table.kerx->table->has_data ();
 }
 
 void
@@ -314,12 +319,15 @@ hb_aat_layout_position (const hb_ot_shape_plan_t *plan,
 			hb_font_t *font,
 			hb_buffer_t *buffer)
 {
-  hb_blob_t *kerx_blob = font->face->table.kerx.get_blob ();
+  const AAT::kerx_accelerator_t &kerx_accel = *font->face->table.kerx;
+  hb_blob_t *kerx_blob = kerx_accel.table.get_blob ();
   const AAT::kerx& kerx = *kerx_blob->as<AAT::kerx> ();
 
   AAT::hb_aat_apply_context_t c (plan, font, buffer, kerx_blob);
   if (!buffer->message (font, "start table kerx")) return;
   c.set_ankr_table (font->face->table.ankr.get ());
+  c.set_class_cache (&kerx_accel.class_cache);
+  c.set_subtable_digests (kerx_accel.subtable_digests);
   kerx.apply (&c);
   (void) buffer->message (font, "end table kerx");
 }
@@ -1616,10 +1616,29 @@ hb_buffer_add_utf (hb_buffer_t  *buffer,
   const T *end = next + item_length;
   while (next < end)
   {
-    hb_codepoint_t u;
-    const T *old_next = next;
-    next = utf_t::next (next, end, &u, replacement);
-    buffer->add (u, old_next - (const T *) text);
+    /* Decode a chunk at a time straight into the info array.  Each code
+     * unit yields at most one character, so a single ensure() covers the
+     * whole chunk, instead of one per character in hb_buffer_t::add(). */
+    unsigned int chunk = hb_min (end - next, 4096);
+    if (unlikely (!buffer->ensure (buffer->len + chunk)))
+    {
+      next = end;
+      break;
+    }
+    const T *chunk_end = next + chunk;
+    hb_glyph_info_t *info = buffer->info + buffer->len;
+    hb_glyph_info_t *info_start = info;
+    while (next < chunk_end)
+    {
+      hb_codepoint_t u;
+      const T *old_next = next;
+      next = utf_t::next (next, end, &u, replacement);
+      *info = hb_glyph_info_t ();
+      info->codepoint = u;
+      info->cluster = old_next - text;
+      info++;
+    }
+    buffer->len += info - info_start;
   }
 
   /* Add post-context */
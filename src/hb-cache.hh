@@ -50,6 +50,10 @@ struct hb_cache_t
 
   bool get (unsigned int key, unsigned int *value) const
   {
+    /* Keys that don't fit would alias the empty-slot pattern.  Shift
+     * in two steps, so key_bits can be the full 32. */
+    if (unlikely (key >> (key_bits - 1) >> 1))
+      return false;
     unsigned int k = key & ((1u<<cache_bits)-1);
     unsigned int v = values[k].get_relaxed ();
     if ((key_bits + value_bits - cache_bits == 8 * sizeof (hb_atomic_int_t) && v == (unsigned int) -1) ||
@@ -61,7 +65,7 @@ struct hb_cache_t
 
   bool set (unsigned int key, unsigned int value)
   {
-    if (unlikely ((key >> key_bits) || (value >> value_bits)))
+    if (unlikely ((key >> (key_bits - 1) >> 1) || (value >> value_bits)))
       return false; /* Overflows */
     unsigned int k = key & ((1u<<cache_bits)-1);
     unsigned int v = ((key>>cache_bits)<<value_bits) | value;
@@ -371,31 +371,35 @@ typedef hb_vector_t<byte_str_t> byte_str_array_t;
 template <typename ELEM, int LIMIT>
 struct cff_stack_t
 {
+  /* The elements live inline, so setting up a stack, which happens once per
+   * charstring interpreted, does not allocate. */
   void init ()
   {
     error = false;
     count = 0;
-    elements.init ();
-    elements.resize (kSizeLimit);
   }
-  void fini () { elements.fini (); }
+  void fini () {}
 
   ELEM& operator [] (unsigned int i)
   {
-    if (unlikely (i >= count)) set_error ();
+    if (unlikely (i >= count))
+    {
+      set_error ();
+      return Crap (ELEM);
+    }
     return elements[i];
   }
 
   void push (const ELEM &v)
   {
-    if (likely (count < elements.length))
+    if (likely (count < kSizeLimit))
       elements[count++] = v;
     else
       set_error ();
   }
   ELEM &push ()
   {
-    if (likely (count < elements.length))
+    if (likely (count < kSizeLimit))
       return elements[count++];
     else
     {
@@ -424,7 +428,7 @@ struct cff_stack_t
 
   const ELEM& peek ()
   {
-    if (unlikely (count < 0))
+    if (unlikely (!count))
     {
       set_error ();
       return Null (ELEM);
@@ -434,7 +438,7 @@ struct cff_stack_t
 
   void unpop ()
   {
-    if (likely (count < elements.length))
+    if (likely (count < kSizeLimit))
       count++;
     else
       set_error ();
@@ -442,7 +446,7 @@ struct cff_stack_t
 
   void clear () { count = 0; }
 
-  bool in_error () const { return (error || elements.in_error ()); }
+  bool in_error () const { return error; }
   void set_error ()      { error = true; }
 
   unsigned int get_count () const { return count; }
@@ -453,7 +457,7 @@ struct cff_stack_t
   protected:
   bool error;
   unsigned int count;
-  hb_vector_t<ELEM> elements;
+  ELEM elements[LIMIT];
 };
 
 /* argument stack */
@@ -509,7 +513,7 @@ struct arg_stack_t : cff_stack_t<ARG, 513>
   }
 
   hb_array_t<const ARG> get_subarray (unsigned int start) const
-  { return S::elements.sub_array (start); }
+  { return hb_array (S::elements).sub_array (start); }
 
   private:
   typedef cff_stack_t<ARG, 513> S;
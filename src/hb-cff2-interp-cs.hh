@@ -40,10 +40,11 @@ struct blend_arg_t : number_t
   void set_real (double v) { reset_blends (); number_t::set_real (v); }
 
   void set_blends (unsigned int numValues_, unsigned int valueIndex_,
-		   unsigned int numBlends, hb_array_t<const blend_arg_t> blends_)
+		   hb_array_t<const blend_arg_t> blends_)
   {
     numValues = numValues_;
     valueIndex = valueIndex_;
+    unsigned int numBlends = blends_.length;
     deltas.resize (numBlends);
     for (unsigned int i = 0; i < numBlends; i++)
       deltas[i] = blends_[i];
@@ -77,14 +78,15 @@ struct cff2_cs_interp_env_t : cs_interp_env_t<blend_arg_t, CFF2Subrs>
     varStore = acc.varStore;
     seen_blend = false;
     seen_vsindex_ = false;
-    scalars.init ();
+    scalars = hb_array_t<float> ();
+    scalars_heap.init ();
     do_blend = num_coords && coords && varStore->size;
     set_ivs (acc.privateDicts[fd].ivs);
   }
 
   void fini ()
   {
-    scalars.fini ();
+    scalars_heap.fini ();
     SUPER::fini ();
   }
 
@@ -121,11 +123,17 @@ struct cff2_cs_interp_env_t : cs_interp_env_t<blend_arg_t, CFF2Subrs>
       region_count = varStore->varStore.get_region_index_count (get_ivs ());
       if (do_blend)
       {
-	if (unlikely (!scalars.resize (region_count)))
+	float *storage = scalars_inline;
+	if (region_count > ARRAY_LENGTH (scalars_inline))
+	  storage = scalars_heap.resize (region_count) ? scalars_heap.arrayZ : nullptr;
+	if (unlikely (!storage))
 	  set_error ();
 	else
+	{
+	  scalars = hb_array (storage, region_count);
 	  varStore->varStore.get_region_scalars (get_ivs (), coords, num_coords,
-						 &scalars[0], region_count);
+						 storage, region_count);
+	}
       }
       seen_blend = true;
     }
@@ -145,6 +153,16 @@ struct cff2_cs_interp_env_t : cs_interp_env_t<blend_arg_t, CFF2Subrs>
     seen_vsindex_ = true;
   }
 
+  /* Value at the font's coordinates of an argument with default value v
+   * and the given deltas, one per region. */
+  double blend_value (double v, hb_array_t<const blend_arg_t> deltas) const
+  {
+    if (do_blend && likely (scalars.length == deltas.length))
+      for (unsigned int i = 0; i < scalars.length; i++)
+	v += (double) scalars[i] * deltas[i].to_real ();
+    return v;
+  }
+
   unsigned int get_region_count () const { return region_count; }
   void	 set_region_count (unsigned int region_count_) { region_count = region_count_; }
   unsigned int get_ivs () const { return ivs; }
@@ -175,7 +193,10 @@ struct cff2_cs_interp_env_t : cs_interp_env_t<blend_arg_t, CFF2Subrs>
   const	 CFF2VariationStore *varStore;
   unsigned int  region_count;
   unsigned int  ivs;
-  hb_vector_t<float>  scalars;
+  hb_array_t<float>   scalars;
+  /* Fonts rarely have many regions; only more than this need the heap. */
+  float		scalars_inline[32];
+  hb_vector_t<float>  scalars_heap;
   bool	  do_blend;
   bool	  seen_vsindex_;
   bool	  seen_blend;
@@ -234,14 +255,21 @@ struct cff2_cs_opset_t : cs_opset_t<blend_arg_t, OPSET, cff2_cs_interp_env_t, PA
     }
     for (unsigned int i = 0; i < n; i++)
     {
-      const hb_array_t<const blend_arg_t>	blends = env.argStack.get_subarray (start + n + (i * k));
-      env.argStack[start + i].set_blends (n, i, k, blends);
+      const hb_array_t<const blend_arg_t>	blends = env.argStack.get_subarray (start + n + (i * k)).sub_array (0, k);
+      OPSET::process_arg_blend (env, env.argStack[start + i], n, i, blends);
     }
 
     /* pop off blend values leaving default values now adorned with blend values */
     env.argStack.pop (k * n);
   }
 
+  /* Keeps the deltas with the argument, to be blended when it is evaluated,
+   * or written back out by the subsetter. */
+  static void process_arg_blend (cff2_cs_interp_env_t &env, blend_arg_t &arg,
+				 unsigned int n, unsigned int i,
+				 hb_array_t<const blend_arg_t> blends)
+  { arg.set_blends (n, i, blends); }
+
   static void process_vsindex (cff2_cs_interp_env_t &env, PARAM& param)
   {
     env.process_vsindex ();
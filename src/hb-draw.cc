@@ -144,6 +144,68 @@ DEFINE_NULL_INSTANCE (hb_draw_funcs_t) =
 };
 
 
+static void
+hb_draw_move_to_outline (hb_draw_funcs_t *dfuncs HB_UNUSED, void *draw_data,
+			 hb_draw_state_t *st HB_UNUSED,
+			 float to_x, float to_y,
+			 void *user_data HB_UNUSED)
+{
+  ((hb_draw_outline_t *) draw_data)->move_to (to_x, to_y);
+}
+
+static void
+hb_draw_line_to_outline (hb_draw_funcs_t *dfuncs HB_UNUSED, void *draw_data,
+			 hb_draw_state_t *st HB_UNUSED,
+			 float to_x, float to_y,
+			 void *user_data HB_UNUSED)
+{
+  ((hb_draw_outline_t *) draw_data)->line_to (to_x, to_y);
+}
+
+static void
+hb_draw_quadratic_to_outline (hb_draw_funcs_t *dfuncs HB_UNUSED, void *draw_data,
+			      hb_draw_state_t *st HB_UNUSED,
+			      float control_x, float control_y,
+			      float to_x, float to_y,
+			      void *user_data HB_UNUSED)
+{
+  ((hb_draw_outline_t *) draw_data)->quadratic_to (control_x, control_y,
+						   to_x, to_y);
+}
+
+static void
+hb_draw_cubic_to_outline (hb_draw_funcs_t *dfuncs HB_UNUSED, void *draw_data,
+			  hb_draw_state_t *st HB_UNUSED,
+			  float control1_x, float control1_y,
+			  float control2_x, float control2_y,
+			  float to_x, float to_y,
+			  void *user_data HB_UNUSED)
+{
+  ((hb_draw_outline_t *) draw_data)->cubic_to (control1_x, control1_y,
+					       control2_x, control2_y,
+					       to_x, to_y);
+}
+
+static void
+hb_draw_close_path_outline (hb_draw_funcs_t *dfuncs HB_UNUSED, void *draw_data,
+			    hb_draw_state_t *st HB_UNUSED,
+			    void *user_data HB_UNUSED)
+{
+  ((hb_draw_outline_t *) draw_data)->close_path ();
+}
+
+const hb_draw_funcs_t _hb_draw_funcs_outline =
+{
+  HB_OBJECT_HEADER_STATIC,
+
+  {
+#define HB_DRAW_FUNC_IMPLEMENT(name) hb_draw_##name##_outline,
+    HB_DRAW_FUNCS_IMPLEMENT_CALLBACKS
+#undef HB_DRAW_FUNC_IMPLEMENT
+  }
+};
+
+
 /**
  * hb_draw_funcs_reference: (skip)
  * @dfuncs: draw functions
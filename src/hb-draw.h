@@ -320,6 +320,33 @@ hb_draw_close_path (hb_draw_funcs_t *dfuncs, void *draw_data,
 		    hb_draw_state_t *st);
 
 
+/**
+ * hb_draw_command_t:
+ * @HB_DRAW_COMMAND_MOVE_TO: Starts a new path; followed by two coordinates,
+ * the point to start at.
+ * @HB_DRAW_COMMAND_LINE_TO: A line segment; followed by two coordinates,
+ * the end point.
+ * @HB_DRAW_COMMAND_QUADRATIC_TO: A quadratic Bézier segment; followed by four
+ * coordinates, the control point and the end point.
+ * @HB_DRAW_COMMAND_CUBIC_TO: A cubic Bézier segment; followed by six
+ * coordinates, the two control points and the end point.
+ * @HB_DRAW_COMMAND_CLOSE_PATH: Closes the current path; has no coordinates.
+ *
+ * The commands of a glyph outline as written by hb_font_get_glyph_outlines().
+ * They come in the same order, and with the same implied segments, as the
+ * calls hb_font_get_glyph_shape() makes to an #hb_draw_funcs_t.
+ *
+ * Since: REPLACEME
+ **/
+typedef enum {
+  HB_DRAW_COMMAND_MOVE_TO,
+  HB_DRAW_COMMAND_LINE_TO,
+  HB_DRAW_COMMAND_QUADRATIC_TO,
+  HB_DRAW_COMMAND_CUBIC_TO,
+  HB_DRAW_COMMAND_CLOSE_PATH
+} hb_draw_command_t;
+
+
 HB_END_DECLS
 
 #endif /* HB_DRAW_H */
@@ -28,6 +28,90 @@
 #include "hb.hh"
 
 
+/*
+ * hb_draw_outline_t
+ */
+
+/* Caller-provided buffers that hb_font_get_glyph_outlines() writes commands
+ * and coordinates to.  Once either runs out the outline is in error; the
+ * caller drops the partly written glyph.  The counts keep going past the
+ * capacities, to tell how much room the outline needed. */
+struct hb_draw_outline_t
+{
+  hb_draw_outline_t (uint8_t *commands_, unsigned int command_capacity_,
+		     float *coords_, unsigned int coord_capacity_)
+    : commands {commands_}, command_capacity {command_capacity_},
+      coords {coords_}, coord_capacity {coord_capacity_} {}
+
+  bool in_error () const { return error; }
+
+  void move_to (float to_x, float to_y)
+  {
+    float *v = add (HB_DRAW_COMMAND_MOVE_TO, 2);
+    if (unlikely (!v)) return;
+    v[0] = to_x; v[1] = to_y;
+  }
+  void line_to (float to_x, float to_y)
+  {
+    float *v = add (HB_DRAW_COMMAND_LINE_TO, 2);
+    if (unlikely (!v)) return;
+    v[0] = to_x; v[1] = to_y;
+  }
+  void quadratic_to (float control_x, float control_y,
+		     float to_x, float to_y)
+  {
+    float *v = add (HB_DRAW_COMMAND_QUADRATIC_TO, 4);
+    if (unlikely (!v)) return;
+    v[0] = control_x; v[1] = control_y;
+    v[2] = to_x; v[3] = to_y;
+  }
+  void cubic_to (float control1_x, float control1_y,
+		 float control2_x, float control2_y,
+		 float to_x, float to_y)
+  {
+    float *v = add (HB_DRAW_COMMAND_CUBIC_TO, 6);
+    if (unlikely (!v)) return;
+    v[0] = control1_x; v[1] = control1_y;
+    v[2] = control2_x; v[3] = control2_y;
+    v[4] = to_x; v[5] = to_y;
+  }
+  void close_path ()
+  { add (HB_DRAW_COMMAND_CLOSE_PATH, 0); }
+
+  protected:
+  /* Appends command and returns where its n coordinates go. */
+  float *add (hb_draw_command_t command, unsigned int n)
+  {
+    if (unlikely (error ||
+		  command_count >= command_capacity ||
+		  n > coord_capacity - coord_count))
+    {
+      error = true;
+      command_count++;
+      coord_count += n;
+      return nullptr;
+    }
+    commands[command_count++] = command;
+    float *v = coords + coord_count;
+    coord_count += n;
+    return v;
+  }
+
+  public:
+  uint8_t *commands;
+  unsigned int command_capacity;
+  unsigned int command_count = 0;
+  float *coords;
+  unsigned int coord_capacity;
+  unsigned int coord_count = 0;
+  bool error = false;
+};
+
+/* Draw funcs that hb_font_get_glyph_outlines() passes down with an
+ * hb_draw_outline_t as draw data; they append to the outline. */
+extern HB_INTERNAL const hb_draw_funcs_t _hb_draw_funcs_outline;
+
+
 /*
  * hb_draw_funcs_t
  */
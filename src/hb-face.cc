@@ -288,12 +288,11 @@ hb_face_destroy (hb_face_t *face)
 {
   if (!hb_object_destroy (face)) return;
 
-  for (hb_face_t::plan_node_t *node = face->shape_plans; node; )
+  hb_shape_plan_cache_t *shape_plans = face->shape_plans;
+  if (shape_plans)
   {
-    hb_face_t::plan_node_t *next = node->next;
-    hb_shape_plan_destroy (node->shape_plan);
-    hb_free (node);
-    node = next;
+    shape_plans->fini ();
+    hb_free (shape_plans);
   }
 
   face->data.fini ();
@@ -533,6 +532,96 @@ hb_face_get_glyph_count (const hb_face_t *face)
   return face->get_num_glyphs ();
 }
 
+/**
+ * hb_face_set_lookup_accelerator_budget:
+ * @face: A face object
+ * @budget: Memory budget in bytes
+ *
+ * Sets how much memory, in bytes, each of the GSUB and GPOS tables of
+ * @face may use to store the exact glyph coverage of its subtables.
+ * Within the budget, shaping avoids dispatching to subtables that do
+ * not apply to a glyph, at the cost of memory.  Subtables that do not
+ * fit fall back to an approximate check.  The default is zero, which
+ * disables exact coverage.
+ *
+ * The budget takes effect when the layout tables are first loaded, so
+ * it must be set before @face is used for shaping.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_face_set_lookup_accelerator_budget (hb_face_t    *face,
+				       unsigned int  budget)
+{
+  if (hb_object_is_immutable (face))
+    return;
+
+  face->lookup_accelerator_budget = budget;
+}
+
+/**
+ * hb_face_get_lookup_accelerator_budget:
+ * @face: A face object
+ *
+ * Fetches the memory budget for exact lookup coverage of @face, as set
+ * by hb_face_set_lookup_accelerator_budget().
+ *
+ * Return value: The budget in bytes
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_face_get_lookup_accelerator_budget (const hb_face_t *face)
+{
+  return face->lookup_accelerator_budget;
+}
+
+/**
+ * hb_face_set_cmap_accelerator_budget:
+ * @face: A face object
+ * @budget: Memory budget in bytes
+ *
+ * Sets how much memory, in bytes, @face may use to flatten the mapping
+ * of its cmap table into a two-level direct lookup table.  When the
+ * flattened table fits in the budget, mapping a character to its nominal
+ * glyph is a pair of array lookups instead of a search of the cmap
+ * subtable.  Only the common format 4 and format 12 subtables are
+ * flattened.  The default is zero, which disables flattening.
+ *
+ * A font that maps most of the BMP needs a bit over 128 kilobytes.
+ *
+ * The budget takes effect when the cmap table is first loaded, so it
+ * must be set before @face is used to map characters.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_face_set_cmap_accelerator_budget (hb_face_t    *face,
+				     unsigned int  budget)
+{
+  if (hb_object_is_immutable (face))
+    return;
+
+  face->cmap_accelerator_budget = budget;
+}
+
+/**
+ * hb_face_get_cmap_accelerator_budget:
+ * @face: A face object
+ *
+ * Fetches the memory budget for a flattened cmap of @face, as set
+ * by hb_face_set_cmap_accelerator_budget().
+ *
+ * Return value: The budget in bytes
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_face_get_cmap_accelerator_budget (const hb_face_t *face)
+{
+  return face->cmap_accelerator_budget;
+}
+
 /**
  * hb_face_get_table_tags:
  * @face: A face object
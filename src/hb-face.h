@@ -134,6 +134,20 @@ hb_face_set_glyph_count (hb_face_t    *face,
 HB_EXTERN unsigned int
 hb_face_get_glyph_count (const hb_face_t *face);
 
+HB_EXTERN void
+hb_face_set_lookup_accelerator_budget (hb_face_t    *face,
+				       unsigned int  budget);
+
+HB_EXTERN unsigned int
+hb_face_get_lookup_accelerator_budget (const hb_face_t *face);
+
+HB_EXTERN void
+hb_face_set_cmap_accelerator_budget (hb_face_t    *face,
+				     unsigned int  budget);
+
+HB_EXTERN unsigned int
+hb_face_get_cmap_accelerator_budget (const hb_face_t *face);
+
 HB_EXTERN unsigned int
 hb_face_get_table_tags (const hb_face_t *face,
 			unsigned int  start_offset,
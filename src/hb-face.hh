@@ -36,6 +36,9 @@
 #include "hb-ot-face.hh"
 
 
+struct hb_shape_plan_cache_t;
+
+
 /*
  * hb_face_t
  */
@@ -55,17 +58,14 @@ struct hb_face_t
   unsigned int index;			/* Face index in a collection, zero-based. */
   mutable hb_atomic_int_t upem;		/* Units-per-EM. */
   mutable hb_atomic_int_t num_glyphs;	/* Number of glyphs. */
+  unsigned int lookup_accelerator_budget; /* Bytes for exact GSUB/GPOS subtable coverage. */
+  unsigned int cmap_accelerator_budget;	/* Bytes for a flattened cmap lookup table. */
 
   hb_shaper_object_dataset_t<hb_face_t> data;/* Various shaper data. */
   hb_ot_face_t table;			/* All the face's tables. */
 
   /* Cache */
-  struct plan_node_t
-  {
-    hb_shape_plan_t *shape_plan;
-    plan_node_t *next;
-  };
-  hb_atomic_ptr_t<plan_node_t> shape_plans;
+  hb_atomic_ptr_t<hb_shape_plan_cache_t> shape_plans; /* Created lazily; see hb-shape-plan.cc. */
 
   hb_blob_t *reference_table (hb_tag_t tag) const
   {
@@ -1320,6 +1320,86 @@ hb_font_get_glyph_shape (hb_font_t *font,
   font->get_glyph_shape (glyph, dfuncs, draw_data);
 }
 
+/**
+ * hb_font_get_glyph_outlines:
+ * @font: #hb_font_t to work upon
+ * @glyph_count: The number of glyphs to fetch outlines for
+ * @first_glyph: The first glyph ID to fetch the outline of
+ * @glyph_stride: The stride between successive glyph IDs
+ * @glyph_command_ends: (out) (optional) (array length=glyph_count):
+ * Where to store, for each glyph written, the index in @commands just past
+ * the glyph's last command
+ * @command_count: (inout): Input = the maximum number of commands to write;
+ * Output = the actual number of commands written
+ * @commands: (out) (array length=command_count): Where to write the
+ * commands, as #hb_draw_command_t values
+ * @coord_count: (inout): Input = the maximum number of coordinates to write;
+ * Output = the actual number of coordinates written
+ * @coords: (out) (array length=coord_count): Where to write the coordinates
+ * the commands take, one x,y pair per point
+ *
+ * Fetches the outlines of a run of glyphs in the specified @font into
+ * compact arrays of commands and coordinates, instead of calling back for
+ * each segment like hb_font_get_glyph_shape() does.  The outlines are the
+ * same as those.
+ *
+ * Outlines are written whole: if the arrays fill up in the middle of a
+ * glyph, nothing of that glyph is kept and the function returns, to be
+ * called again for the remaining glyphs.  If not even the first glyph
+ * fits, zero is returned and @command_count and @coord_count are set to
+ * the number of commands and coordinates that glyph needs.
+ *
+ * Return value: the number of glyphs whose outlines were written.
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_font_get_glyph_outlines (hb_font_t *font,
+			    unsigned int glyph_count,
+			    const hb_codepoint_t *first_glyph,
+			    unsigned int glyph_stride,
+			    unsigned int *glyph_command_ends, /* OUT, may be NULL */
+			    unsigned int *command_count, /* IN/OUT */
+			    uint8_t *commands, /* OUT */
+			    unsigned int *coord_count, /* IN/OUT */
+			    float *coords /* OUT */)
+{
+#ifdef HB_NO_DRAW
+  *command_count = *coord_count = 0;
+  return 0;
+#else
+  hb_draw_outline_t outline (commands, *command_count, coords, *coord_count);
+  hb_draw_funcs_t *dfuncs = const_cast<hb_draw_funcs_t *> (&_hb_draw_funcs_outline);
+
+  unsigned int i;
+  for (i = 0; i < glyph_count; i++)
+  {
+    unsigned int commands_before = outline.command_count;
+    unsigned int coords_before = outline.coord_count;
+
+    font->get_glyph_shape (*first_glyph, dfuncs, &outline);
+    if (unlikely (outline.in_error ()))
+    {
+      /* On the first glyph, leave what it needed in the counts. */
+      if (i)
+      {
+	outline.command_count = commands_before;
+	outline.coord_count = coords_before;
+      }
+      break;
+    }
+
+    if (glyph_command_ends)
+      glyph_command_ends[i] = outline.command_count;
+    first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
+  }
+
+  *command_count = outline.command_count;
+  *coord_count = outline.coord_count;
+  return i;
+#endif
+}
+
 /* A bit higher-level, and with fallback */
 
 /**
@@ -1623,6 +1703,9 @@ DEFINE_NULL_INSTANCE (hb_font_t) =
 {
   HB_OBJECT_HEADER_STATIC,
 
+  0, /* serial */
+  0, /* serial_coords */
+
   nullptr, /* parent */
   const_cast<hb_face_t *> (&_hb_Null_hb_face_t),
 
@@ -1640,6 +1723,7 @@ DEFINE_NULL_INSTANCE (hb_font_t) =
   0, /* num_coords */
   nullptr, /* coords */
   nullptr, /* design_coords */
+  nullptr, /* var_region_scalars */
 
   const_cast<hb_font_funcs_t *> (&_hb_Null_hb_font_funcs_t),
 
@@ -1711,10 +1795,13 @@ _hb_font_adopt_var_coords (hb_font_t *font,
 {
   hb_free (font->coords);
   hb_free (font->design_coords);
+  font->var_region_scalars_fini ();
 
   font->coords = coords;
   font->design_coords = design_coords;
   font->num_coords = coords_length;
+
+  font->serial_coords = ++font->serial;
 }
 
 /**
@@ -1827,6 +1914,7 @@ hb_font_destroy (hb_font_t *font)
 
   hb_free (font->coords);
   hb_free (font->design_coords);
+  font->var_region_scalars_fini ();
 
   hb_free (font);
 }
@@ -1929,6 +2017,11 @@ hb_font_set_parent (hb_font_t *font,
   if (!parent)
     parent = hb_font_get_empty ();
 
+  if (parent == font->parent)
+    return;
+
+  font->serial++;
+
   hb_font_t *old = font->parent;
 
   font->parent = hb_font_reference (parent);
@@ -1971,10 +2064,16 @@ hb_font_set_face (hb_font_t *font,
   if (unlikely (!face))
     face = hb_face_get_empty ();
 
+  if (face == font->face)
+    return;
+
+  font->serial++;
+
   hb_face_t *old = font->face;
 
   hb_face_make_immutable (face);
   font->face = hb_face_reference (face);
+  font->var_region_scalars_fini ();
   font->mults_changed ();
 
   hb_face_destroy (old);
@@ -2022,6 +2121,8 @@ hb_font_set_funcs (hb_font_t         *font,
     return;
   }
 
+  font->serial++;
+
   if (font->destroy)
     font->destroy (font->user_data);
 
@@ -2059,6 +2160,8 @@ hb_font_set_funcs_data (hb_font_t         *font,
     return;
   }
 
+  font->serial++;
+
   if (font->destroy)
     font->destroy (font->user_data);
 
@@ -2085,6 +2188,11 @@ hb_font_set_scale (hb_font_t *font,
   if (hb_object_is_immutable (font))
     return;
 
+  if (font->x_scale == x_scale && font->y_scale == y_scale)
+    return;
+
+  font->serial++;
+
   font->x_scale = x_scale;
   font->y_scale = y_scale;
   font->mults_changed ();
@@ -2127,6 +2235,11 @@ hb_font_set_ppem (hb_font_t    *font,
   if (hb_object_is_immutable (font))
     return;
 
+  if (font->x_ppem == x_ppem && font->y_ppem == y_ppem)
+    return;
+
+  font->serial++;
+
   font->x_ppem = x_ppem;
   font->y_ppem = y_ppem;
 }
@@ -2169,6 +2282,11 @@ hb_font_set_ptem (hb_font_t *font,
   if (hb_object_is_immutable (font))
     return;
 
+  if (font->ptem == ptem)
+    return;
+
+  font->serial++;
+
   font->ptem = ptem;
 }
 
@@ -2216,6 +2334,11 @@ hb_font_set_synthetic_slant (hb_font_t *font, float slant)
   if (hb_object_is_immutable (font))
     return;
 
+  if (font->slant == slant)
+    return;
+
+  font->serial++;
+
   font->slant = slant;
   font->mults_changed ();
 }
@@ -890,6 +890,17 @@ hb_font_get_glyph_shape (hb_font_t *font,
 			 hb_codepoint_t glyph,
 			 hb_draw_funcs_t *dfuncs, void *draw_data);
 
+HB_EXTERN unsigned int
+hb_font_get_glyph_outlines (hb_font_t *font,
+			    unsigned int glyph_count,
+			    const hb_codepoint_t *first_glyph,
+			    unsigned int glyph_stride,
+			    unsigned int *glyph_command_ends, /* OUT, may be NULL */
+			    unsigned int *command_count, /* IN/OUT */
+			    uint8_t *commands, /* OUT */
+			    unsigned int *coord_count, /* IN/OUT */
+			    float *coords /* OUT */);
+
 
 /* high-level funcs, with fallback */
 
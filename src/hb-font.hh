@@ -104,6 +104,8 @@ DECLARE_NULL_INSTANCE (hb_font_funcs_t);
 struct hb_font_t
 {
   hb_object_header_t header;
+  unsigned int serial;
+  unsigned int serial_coords;
 
   hb_font_t *parent;
   hb_face_t *face;
@@ -125,6 +127,17 @@ struct hb_font_t
   int *coords;
   float *design_coords;
 
+  /* Region scalars of the VariationStores used with this font, evaluated
+   * at the current coordinates.  Filled lazily by OT::VarRegionList;
+   * flushed whenever the coordinates or the face change. */
+  struct var_region_scalars_t
+  {
+    const void *regions; /* The OT::VarRegionList these belong to. */
+    var_region_scalars_t *next;
+    float *scalars;
+  };
+  hb_atomic_ptr_t<var_region_scalars_t> var_region_scalars;
+
   hb_font_funcs_t   *klass;
   void              *user_data;
   hb_destroy_func_t  destroy;
@@ -626,6 +639,17 @@ struct hb_font_t
     return false;
   }
 
+  void var_region_scalars_fini ()
+  {
+    for (var_region_scalars_t *node = var_region_scalars.get (); node; )
+    {
+      var_region_scalars_t *next = node->next;
+      hb_free (node);
+      node = next;
+    }
+    var_region_scalars.set_relaxed (nullptr);
+  }
+
   void mults_changed ()
   {
     signed upem = face->get_upem ();
@@ -31,6 +31,7 @@
 #include "hb-ot-layout-common.hh"
 #include "hb-cff-interp-dict-common.hh"
 #include "hb-subset-plan.hh"
+#include "hb-draw.hh"
 
 namespace CFF {
 
@@ -615,6 +616,66 @@ struct Subrs : CFFIndex<COUNT>
   typedef CFFIndex<COUNT> SUPER;
 };
 
+/* A glyph outline in font units, recorded from the charstring
+ * interpreter so that it can be drawn again without interpreting. */
+struct cff_outline_t
+{
+  enum op_t : uint8_t { MOVE_TO, LINE_TO, CUBIC_TO, CLOSE_PATH };
+
+  void move_to (float x, float y)
+  {
+    ops.push (MOVE_TO);
+    coords.push (x); coords.push (y);
+  }
+  void line_to (float x, float y)
+  {
+    ops.push (LINE_TO);
+    coords.push (x); coords.push (y);
+  }
+  void cubic_to (float x1, float y1, float x2, float y2, float x3, float y3)
+  {
+    ops.push (CUBIC_TO);
+    coords.push (x1); coords.push (y1);
+    coords.push (x2); coords.push (y2);
+    coords.push (x3); coords.push (y3);
+  }
+  void close_path () { ops.push (CLOSE_PATH); }
+
+  bool in_error () const { return ops.in_error () || coords.in_error (); }
+
+  unsigned int get_size () const
+  { return ops.length * sizeof (ops[0]) + coords.length * sizeof (coords[0]); }
+
+  /* Scales exactly as the interpreter-driven path would. */
+  void replay (hb_font_t *font, hb_draw_session_t &draw_session) const
+  {
+    const float *c = coords.arrayZ;
+    for (uint8_t op : ops)
+      switch (op) {
+      case MOVE_TO:
+	draw_session.move_to (font->em_fscalef_x (c[0]), font->em_fscalef_y (c[1]));
+	c += 2;
+	break;
+      case LINE_TO:
+	draw_session.line_to (font->em_fscalef_x (c[0]), font->em_fscalef_y (c[1]));
+	c += 2;
+	break;
+      case CUBIC_TO:
+	draw_session.cubic_to (font->em_fscalef_x (c[0]), font->em_fscalef_y (c[1]),
+			       font->em_fscalef_x (c[2]), font->em_fscalef_y (c[3]),
+			       font->em_fscalef_x (c[4]), font->em_fscalef_y (c[5]));
+	c += 6;
+	break;
+      case CLOSE_PATH:
+	draw_session.close_path ();
+	break;
+      }
+  }
+
+  hb_vector_t<uint8_t> ops;
+  hb_vector_t<float> coords;
+};
+
 } /* namespace CFF */
 
 #endif /* HB_OT_CFF_COMMON_HH */
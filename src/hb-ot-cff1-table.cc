@@ -442,12 +442,16 @@ bool OT::cff1::accelerator_t::get_extents (hb_font_t *font, hb_codepoint_t glyph
   return true;
 }
 
+/* Draws to draw_session, or if outline is set, records the path there
+ * in font units instead. */
 struct cff1_path_param_t
 {
   cff1_path_param_t (const OT::cff1::accelerator_t *cff_, hb_font_t *font_,
-		     hb_draw_session_t &draw_session_, point_t *delta_)
+		     hb_draw_session_t *draw_session_, cff_outline_t *outline_,
+		     point_t *delta_)
   {
-    draw_session = &draw_session_;
+    draw_session = draw_session_;
+    outline = outline_;
     cff = cff_;
     font = font_;
     delta = delta_;
@@ -457,14 +461,20 @@ struct cff1_path_param_t
   {
     point_t point = p;
     if (delta) point.move (*delta);
-    draw_session->move_to (font->em_fscalef_x (point.x.to_real ()), font->em_fscalef_y (point.y.to_real ()));
+    if (outline)
+      outline->move_to (point.x.to_real (), point.y.to_real ());
+    else
+      draw_session->move_to (font->em_fscalef_x (point.x.to_real ()), font->em_fscalef_y (point.y.to_real ()));
   }
 
   void line_to (const point_t &p)
   {
     point_t point = p;
     if (delta) point.move (*delta);
-    draw_session->line_to (font->em_fscalef_x (point.x.to_real ()), font->em_fscalef_y (point.y.to_real ()));
+    if (outline)
+      outline->line_to (point.x.to_real (), point.y.to_real ());
+    else
+      draw_session->line_to (font->em_fscalef_x (point.x.to_real ()), font->em_fscalef_y (point.y.to_real ()));
   }
 
   void cubic_to (const point_t &p1, const point_t &p2, const point_t &p3)
@@ -476,15 +486,27 @@ struct cff1_path_param_t
       point2.move (*delta);
       point3.move (*delta);
     }
-    draw_session->cubic_to (font->em_fscalef_x (point1.x.to_real ()), font->em_fscalef_y (point1.y.to_real ()),
-			   font->em_fscalef_x (point2.x.to_real ()), font->em_fscalef_y (point2.y.to_real ()),
-			   font->em_fscalef_x (point3.x.to_real ()), font->em_fscalef_y (point3.y.to_real ()));
+    if (outline)
+      outline->cubic_to (point1.x.to_real (), point1.y.to_real (),
+			 point2.x.to_real (), point2.y.to_real (),
+			 point3.x.to_real (), point3.y.to_real ());
+    else
+      draw_session->cubic_to (font->em_fscalef_x (point1.x.to_real ()), font->em_fscalef_y (point1.y.to_real ()),
+			     font->em_fscalef_x (point2.x.to_real ()), font->em_fscalef_y (point2.y.to_real ()),
+			     font->em_fscalef_x (point3.x.to_real ()), font->em_fscalef_y (point3.y.to_real ()));
   }
 
-  void end_path () { draw_session->close_path (); }
+  void end_path ()
+  {
+    if (outline)
+      outline->close_path ();
+    else
+      draw_session->close_path ();
+  }
 
   hb_font_t *font;
   hb_draw_session_t *draw_session;
+  cff_outline_t *outline;
   point_t *delta;
 
   const OT::cff1::accelerator_t *cff;
@@ -512,7 +534,8 @@ struct cff1_path_procs_path_t : path_procs_t<cff1_path_procs_path_t, cff1_cs_int
 };
 
 static bool _get_path (const OT::cff1::accelerator_t *cff, hb_font_t *font, hb_codepoint_t glyph,
-		       hb_draw_session_t &draw_session, bool in_seac = false, point_t *delta = nullptr);
+		       hb_draw_session_t *draw_session, cff_outline_t *outline,
+		       bool in_seac = false, point_t *delta = nullptr);
 
 struct cff1_cs_opset_path_t : cff1_cs_opset_t<cff1_cs_opset_path_t, cff1_path_param_t, cff1_path_procs_path_t>
 {
@@ -529,14 +552,15 @@ struct cff1_cs_opset_path_t : cff1_cs_opset_t<cff1_cs_opset_path_t, cff1_path_pa
     hb_codepoint_t accent = param.cff->std_code_to_glyph (env.argStack[n-1].to_int ());
 
     if (unlikely (!(!env.in_seac && base && accent
-		    && _get_path (param.cff, param.font, base, *param.draw_session, true)
-		    && _get_path (param.cff, param.font, accent, *param.draw_session, true, &delta))))
+		    && _get_path (param.cff, param.font, base, param.draw_session, param.outline, true)
+		    && _get_path (param.cff, param.font, accent, param.draw_session, param.outline, true, &delta))))
       env.set_error ();
   }
 };
 
 bool _get_path (const OT::cff1::accelerator_t *cff, hb_font_t *font, hb_codepoint_t glyph,
-		hb_draw_session_t &draw_session, bool in_seac, point_t *delta)
+		hb_draw_session_t *draw_session, cff_outline_t *outline,
+		bool in_seac, point_t *delta)
 {
   if (unlikely (!cff->is_valid () || (glyph >= cff->num_glyphs))) return false;
 
@@ -545,7 +569,7 @@ bool _get_path (const OT::cff1::accelerator_t *cff, hb_font_t *font, hb_codepoin
   const byte_str_t str = (*cff->charStrings)[glyph];
   interp.env.init (str, *cff, fd);
   interp.env.set_in_seac (in_seac);
-  cff1_path_param_t param (cff, font, draw_session, delta);
+  cff1_path_param_t param (cff, font, draw_session, outline, delta);
   if (unlikely (!interp.interpret (param))) return false;
 
   /* Let's end the path specially since it is called inside seac also */
@@ -561,7 +585,17 @@ bool OT::cff1::accelerator_t::get_path (hb_font_t *font, hb_codepoint_t glyph, h
   return true;
 #endif
 
-  return _get_path (this, font, glyph, draw_session);
+  return _get_path (this, font, glyph, &draw_session, nullptr);
+}
+
+bool OT::cff1::accelerator_t::get_outline (hb_font_t *font, hb_codepoint_t glyph, cff_outline_t &outline) const
+{
+#ifdef HB_NO_OT_FONT_CFF
+  /* XXX Remove check when this code moves to .hh file. */
+  return true;
+#endif
+
+  return _get_path (this, font, glyph, nullptr, &outline) && !outline.in_error ();
 }
 
 struct get_seac_param_t
@@ -1348,6 +1348,8 @@ struct cff1
     HB_INTERNAL bool get_extents (hb_font_t *font, hb_codepoint_t glyph, hb_glyph_extents_t *extents) const;
     HB_INTERNAL bool get_seac_components (hb_codepoint_t glyph, hb_codepoint_t *base, hb_codepoint_t *accent) const;
     HB_INTERNAL bool get_path (hb_font_t *font, hb_codepoint_t glyph, hb_draw_session_t &draw_session) const;
+    /* Like get_path(), but records the outline, in font units. */
+    HB_INTERNAL bool get_outline (hb_font_t *font, hb_codepoint_t glyph, CFF::cff_outline_t &outline) const;
 
     private:
     struct gname_t
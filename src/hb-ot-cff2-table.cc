@@ -64,6 +64,18 @@ struct cff2_extents_param_t
   number_t max_y;
 };
 
+/* Outlines are only ever evaluated at the font's coordinates, so blended
+ * arguments are resolved as soon as they are read; that saves copying their
+ * deltas, which would allocate. */
+template <typename OPSET, typename PARAM, typename PATH>
+struct cff2_cs_opset_resolve_blends_t : cff2_cs_opset_t<OPSET, PARAM, PATH>
+{
+  static void process_arg_blend (cff2_cs_interp_env_t &env, blend_arg_t &arg,
+				 unsigned int n HB_UNUSED, unsigned int i HB_UNUSED,
+				 hb_array_t<const blend_arg_t> blends)
+  { arg.set_real (env.blend_value (arg.to_real (), blends)); }
+};
+
 struct cff2_path_procs_extents_t : path_procs_t<cff2_path_procs_extents_t, cff2_cs_interp_env_t, cff2_extents_param_t>
 {
   static void moveto (cff2_cs_interp_env_t &env, cff2_extents_param_t& param, const point_t &pt)
@@ -98,7 +110,7 @@ struct cff2_path_procs_extents_t : path_procs_t<cff2_path_procs_extents_t, cff2_
   }
 };
 
-struct cff2_cs_opset_extents_t : cff2_cs_opset_t<cff2_cs_opset_extents_t, cff2_extents_param_t, cff2_path_procs_extents_t> {};
+struct cff2_cs_opset_extents_t : cff2_cs_opset_resolve_blends_t<cff2_cs_opset_extents_t, cff2_extents_param_t, cff2_path_procs_extents_t> {};
 
 bool OT::cff2::accelerator_t::get_extents (hb_font_t *font,
 					   hb_codepoint_t glyph,
@@ -143,29 +155,49 @@ bool OT::cff2::accelerator_t::get_extents (hb_font_t *font,
   return true;
 }
 
+/* Draws to draw_session, or if outline is set, records the path there
+ * in font units instead. */
 struct cff2_path_param_t
 {
-  cff2_path_param_t (hb_font_t *font_, hb_draw_session_t &draw_session_)
+  cff2_path_param_t (hb_font_t *font_, hb_draw_session_t *draw_session_,
+		     cff_outline_t *outline_ = nullptr)
   {
-    draw_session = &draw_session_;
+    draw_session = draw_session_;
+    outline = outline_;
     font = font_;
   }
 
   void move_to (const point_t &p)
-  { draw_session->move_to (font->em_fscalef_x (p.x.to_real ()), font->em_fscalef_y (p.y.to_real ())); }
+  {
+    if (outline)
+      outline->move_to (p.x.to_real (), p.y.to_real ());
+    else
+      draw_session->move_to (font->em_fscalef_x (p.x.to_real ()), font->em_fscalef_y (p.y.to_real ()));
+  }
 
   void line_to (const point_t &p)
-  { draw_session->line_to (font->em_fscalef_x (p.x.to_real ()), font->em_fscalef_y (p.y.to_real ())); }
+  {
+    if (outline)
+      outline->line_to (p.x.to_real (), p.y.to_real ());
+    else
+      draw_session->line_to (font->em_fscalef_x (p.x.to_real ()), font->em_fscalef_y (p.y.to_real ()));
+  }
 
   void cubic_to (const point_t &p1, const point_t &p2, const point_t &p3)
   {
-    draw_session->cubic_to (font->em_fscalef_x (p1.x.to_real ()), font->em_fscalef_y (p1.y.to_real ()),
-			   font->em_fscalef_x (p2.x.to_real ()), font->em_fscalef_y (p2.y.to_real ()),
-			   font->em_fscalef_x (p3.x.to_real ()), font->em_fscalef_y (p3.y.to_real ()));
+    if (outline)
+      outline->cubic_to (p1.x.to_real (), p1.y.to_real (),
+			 p2.x.to_real (), p2.y.to_real (),
+			 p3.x.to_real (), p3.y.to_real ());
+    else
+      draw_session->cubic_to (font->em_fscalef_x (p1.x.to_real ()), font->em_fscalef_y (p1.y.to_real ()),
+			     font->em_fscalef_x (p2.x.to_real ()), font->em_fscalef_y (p2.y.to_real ()),
+			     font->em_fscalef_x (p3.x.to_real ()), font->em_fscalef_y (p3.y.to_real ()));
   }
 
   protected:
   hb_draw_session_t *draw_session;
+  cff_outline_t *outline;
   hb_font_t *font;
 };
 
@@ -190,7 +222,22 @@ struct cff2_path_procs_path_t : path_procs_t<cff2_path_procs_path_t, cff2_cs_int
   }
 };
 
-struct cff2_cs_opset_path_t : cff2_cs_opset_t<cff2_cs_opset_path_t, cff2_path_param_t, cff2_path_procs_path_t> {};
+struct cff2_cs_opset_path_t : cff2_cs_opset_resolve_blends_t<cff2_cs_opset_path_t, cff2_path_param_t, cff2_path_procs_path_t> {};
+
+static bool
+_get_path (const OT::cff2::accelerator_t *cff, hb_font_t *font, hb_codepoint_t glyph,
+	   hb_draw_session_t *draw_session, cff_outline_t *outline)
+{
+  if (unlikely (!cff->is_valid () || (glyph >= cff->num_glyphs))) return false;
+
+  unsigned int fd = cff->fdSelect->get_fd (glyph);
+  cff2_cs_interpreter_t<cff2_cs_opset_path_t, cff2_path_param_t> interp;
+  const byte_str_t str = (*cff->charStrings)[glyph];
+  interp.env.init (str, *cff, fd, font->coords, font->num_coords);
+  cff2_path_param_t param (font, draw_session, outline);
+  if (unlikely (!interp.interpret (param))) return false;
+  return true;
+}
 
 bool OT::cff2::accelerator_t::get_path (hb_font_t *font, hb_codepoint_t glyph, hb_draw_session_t &draw_session) const
 {
@@ -199,15 +246,17 @@ bool OT::cff2::accelerator_t::get_path (hb_font_t *font, hb_codepoint_t glyph, h
   return true;
 #endif
 
-  if (unlikely (!is_valid () || (glyph >= num_glyphs))) return false;
+  return _get_path (this, font, glyph, &draw_session, nullptr);
+}
 
-  unsigned int fd = fdSelect->get_fd (glyph);
-  cff2_cs_interpreter_t<cff2_cs_opset_path_t, cff2_path_param_t> interp;
-  const byte_str_t str = (*charStrings)[glyph];
-  interp.env.init (str, *this, fd, font->coords, font->num_coords);
-  cff2_path_param_t param (font, draw_session);
-  if (unlikely (!interp.interpret (param))) return false;
+bool OT::cff2::accelerator_t::get_outline (hb_font_t *font, hb_codepoint_t glyph, cff_outline_t &outline) const
+{
+#ifdef HB_NO_OT_FONT_CFF
+  /* XXX Remove check when this code moves to .hh file. */
   return true;
+#endif
+
+  return _get_path (this, font, glyph, nullptr, &outline) && !outline.in_error ();
 }
 
 #endif
@@ -516,6 +516,8 @@ struct cff2
 				  hb_codepoint_t glyph,
 				  hb_glyph_extents_t *extents) const;
     HB_INTERNAL bool get_path (hb_font_t *font, hb_codepoint_t glyph, hb_draw_session_t &draw_session) const;
+    /* Like get_path(), but records the outline, in font units. */
+    HB_INTERNAL bool get_outline (hb_font_t *font, hb_codepoint_t glyph, CFF::cff_outline_t &outline) const;
   };
 
   typedef accelerator_templ_t<cff2_private_dict_opset_subset_t, cff2_private_dict_values_subset_t> accelerator_subset_t;
@@ -90,6 +90,20 @@ struct CmapSubtableFormat0
   DEFINE_SIZE_STATIC (6 + 256);
 };
 
+/* A run of codepoints that map to glyphs by a constant offset, as
+ * found while looking up one of them.  Lets batch lookups skip
+ * searching the subtable while the codepoints stay inside it. */
+struct CmapGlyphRun
+{
+  bool contains (hb_codepoint_t u) const { return start <= u && u <= end; }
+  hb_codepoint_t get_glyph (hb_codepoint_t u) const { return (u + delta) & mask; }
+
+  hb_codepoint_t start = 1;
+  hb_codepoint_t end = 0;
+  hb_codepoint_t delta = 0;
+  hb_codepoint_t mask = 0;
+};
+
 struct CmapSubtableFormat4
 {
 
@@ -382,6 +396,13 @@ struct CmapSubtableFormat4
     }
 
     bool get_glyph (hb_codepoint_t codepoint, hb_codepoint_t *glyph) const
+    {
+      CmapGlyphRun run;
+      return get_glyph (codepoint, glyph, &run);
+    }
+
+    bool get_glyph (hb_codepoint_t codepoint, hb_codepoint_t *glyph,
+		    CmapGlyphRun *run) const
     {
       struct CustomRange
       {
@@ -424,11 +445,27 @@ struct CmapSubtableFormat4
       if (!gid)
 	return false;
       *glyph = gid;
+
+      run->mask = 0xFFFFu;
+      if (rangeOffset == 0)
+      {
+	run->start = this->startCount[i];
+	run->end = this->endCount[i];
+	run->delta = this->idDelta[i];
+      }
+      else
+      {
+	run->start = run->end = codepoint;
+	run->delta = gid - codepoint;
+      }
       return true;
     }
 
     HB_INTERNAL static bool get_glyph_func (const void *obj, hb_codepoint_t codepoint, hb_codepoint_t *glyph)
     { return ((const accelerator_t *) obj)->get_glyph (codepoint, glyph); }
+    HB_INTERNAL static bool get_glyph_run_func (const void *obj, hb_codepoint_t codepoint, hb_codepoint_t *glyph,
+						CmapGlyphRun *run)
+    { return ((const accelerator_t *) obj)->get_glyph (codepoint, glyph, run); }
 
     void collect_unicodes (hb_set_t *out) const
     {
@@ -772,6 +809,25 @@ struct CmapSubtableFormat12 : CmapSubtableLongSegmented<CmapSubtableFormat12>
   { return likely (group.startCharCode <= group.endCharCode) ?
 	   group.glyphID + (u - group.startCharCode) : 0; }
 
+  bool get_glyph (hb_codepoint_t codepoint, hb_codepoint_t *glyph) const
+  { return CmapSubtableLongSegmented<CmapSubtableFormat12>::get_glyph (codepoint, glyph); }
+
+  bool get_glyph (hb_codepoint_t codepoint, hb_codepoint_t *glyph,
+		  CmapGlyphRun *run) const
+  {
+    const CmapSubtableLongGroup &group = groups.bsearch (codepoint);
+    hb_codepoint_t gid = group_get_glyph (group, codepoint);
+    if (!gid)
+      return false;
+    *glyph = gid;
+
+    run->start = group.startCharCode;
+    run->end = group.endCharCode;
+    run->delta = group.glyphID - group.startCharCode;
+    run->mask = 0xFFFFFFFFu;
+    return true;
+  }
+
 
   template<typename Iterator,
 	   hb_requires (hb_is_iterator (Iterator))>
@@ -1687,39 +1743,76 @@ struct cmap
 	  break;
 	case 12:
 	  this->get_glyph_funcZ = get_glyph_from<CmapSubtableFormat12>;
+	  this->get_glyph_run_funcZ = get_glyph_run_from<CmapSubtableFormat12>;
 	  break;
 	case  4:
 	{
 	  this->format4_accel.init (&subtable->u.format4);
 	  this->get_glyph_data = &this->format4_accel;
 	  this->get_glyph_funcZ = this->format4_accel.get_glyph_func;
+	  this->get_glyph_run_funcZ = this->format4_accel.get_glyph_run_func;
 	  break;
 	}
 	}
       }
+
+      unsigned budget = face->cmap_accelerator_budget;
+      if (budget && (subtable->u.format == 4 || subtable->u.format == 12))
+	flatten (budget, symbol);
     }
     ~accelerator_t () { this->table.destroy (); }
 
+    template <typename cache_t = void>
     bool get_nominal_glyph (hb_codepoint_t  unicode,
-			    hb_codepoint_t *glyph) const
+			    hb_codepoint_t *glyph,
+			    cache_t *cache = nullptr) const
     {
       if (unlikely (!this->get_glyph_funcZ)) return false;
-      return this->get_glyph_funcZ (this->get_glyph_data, unicode, glyph);
+      if (flat_pages.length)
+	return _flat_get (unicode, glyph);
+      return _cached_get (unicode, glyph, cache);
     }
+    template <typename cache_t = void>
     unsigned int get_nominal_glyphs (unsigned int count,
 				     const hb_codepoint_t *first_unicode,
 				     unsigned int unicode_stride,
 				     hb_codepoint_t *first_glyph,
-				     unsigned int glyph_stride) const
+				     unsigned int glyph_stride,
+				     cache_t *cache = nullptr) const
     {
       if (unlikely (!this->get_glyph_funcZ)) return 0;
 
-      hb_cmap_get_glyph_func_t get_glyph_funcZ = this->get_glyph_funcZ;
-      const void *get_glyph_data = this->get_glyph_data;
-
       unsigned int done;
+      if (flat_pages.length)
+      {
+	for (done = 0;
+	     done < count && _flat_get (*first_unicode, first_glyph);
+	     done++)
+	{
+	  first_unicode = &StructAtOffsetUnaligned<hb_codepoint_t> (first_unicode, unicode_stride);
+	  first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
+	}
+	return done;
+      }
+
+      if (this->get_glyph_run_funcZ)
+      {
+	/* Text tends to stay within a few runs of consecutive codepoints
+	 * (eg. ASCII letters); remember the last one so that codepoints
+	 * missing from the cache can often skip the search. */
+	CmapGlyphRun run;
+	for (done = 0;
+	     done < count && _cached_get_run (*first_unicode, first_glyph, &run, cache);
+	     done++)
+	{
+	  first_unicode = &StructAtOffsetUnaligned<hb_codepoint_t> (first_unicode, unicode_stride);
+	  first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
+	}
+	return done;
+      }
+
       for (done = 0;
-	   done < count && get_glyph_funcZ (get_glyph_data, *first_unicode, first_glyph);
+	   done < count && _cached_get (*first_unicode, first_glyph, cache);
 	   done++)
       {
 	first_unicode = &StructAtOffsetUnaligned<hb_codepoint_t> (first_unicode, unicode_stride);
@@ -1756,9 +1849,142 @@ struct cmap
     { subtable_uvs->collect_variation_unicodes (variation_selector, out); }
 
     protected:
+    /* Builds a direct lookup table of the mapped codepoints, if it fits in
+     * budget bytes.  flat_pages has the page number of each run of 256
+     * codepoints up to the largest mapped one, and flat_glyphs holds the
+     * pages of glyph ids.  Page 0 is left empty for runs with nothing mapped.
+     * The table is filled through get_glyph_funcZ, so it agrees with the
+     * subtable exactly; a glyph id of zero means unmapped. */
+    void flatten (unsigned budget, bool symbol)
+    {
+      hb_set_t unicodes;
+      subtable->collect_unicodes (&unicodes);
+      if (symbol)
+	unicodes.add_range (0, 0xFFu); /* See get_glyph_from_symbol (). */
+      if (unlikely (unicodes.in_error () || !unicodes)) return;
+
+      hb_codepoint_t max_unicode = unicodes.get_max ();
+      unsigned num_index = (max_unicode >> 8) + 1;
+      unsigned num_pages = 1;
+      hb_codepoint_t first = HB_SET_VALUE_INVALID, last = HB_SET_VALUE_INVALID;
+      unsigned last_page = (unsigned) -1;
+      while (unicodes.next_range (&first, &last))
+      {
+	num_pages += (last >> 8) - (first >> 8) + 1;
+	if ((first >> 8) == last_page) num_pages--;
+	last_page = last >> 8;
+      }
+
+      if (num_pages > 0x10000u ||
+	  (num_index + ((size_t) num_pages << 8)) * sizeof (uint16_t) > budget)
+	return;
+
+      if (unlikely (!flat_pages.resize (num_index) ||
+		    !flat_glyphs.resize (num_pages << 8)))
+	goto fail;
+
+      {
+	unsigned page = 0;
+	last_page = (unsigned) -1;
+	for (hb_codepoint_t u : unicodes)
+	{
+	  if ((u >> 8) != last_page)
+	  {
+	    last_page = u >> 8;
+	    flat_pages.arrayZ[last_page] = ++page;
+	  }
+	  hb_codepoint_t gid;
+	  if (!this->get_glyph_funcZ (this->get_glyph_data, u, &gid)) continue;
+	  if (unlikely (gid > 0xFFFFu)) goto fail;
+	  flat_glyphs.arrayZ[(page << 8) | (u & 0xFFu)] = gid;
+	}
+      }
+      return;
+
+    fail:
+      flat_pages.fini ();
+      flat_glyphs.fini ();
+    }
+
+    bool _flat_get (hb_codepoint_t  unicode,
+		    hb_codepoint_t *glyph) const
+    {
+      if (unlikely ((unicode >> 8) >= flat_pages.length))
+	/* Only malformed subtables map anything up here. */
+	return this->get_glyph_funcZ (this->get_glyph_data, unicode, glyph);
+
+      hb_codepoint_t gid = flat_glyphs.arrayZ[(flat_pages.arrayZ[unicode >> 8] << 8) | (unicode & 0xFFu)];
+      if (!gid) return false;
+      *glyph = gid;
+      return true;
+    }
+
     typedef bool (*hb_cmap_get_glyph_func_t) (const void *obj,
 					      hb_codepoint_t codepoint,
 					      hb_codepoint_t *glyph);
+    typedef bool (*hb_cmap_get_glyph_run_func_t) (const void *obj,
+						  hb_codepoint_t codepoint,
+						  hb_codepoint_t *glyph,
+						  CmapGlyphRun *run);
+
+    bool _cached_get (hb_codepoint_t  unicode,
+		      hb_codepoint_t *glyph,
+		      void *cache HB_UNUSED) const
+    { return this->get_glyph_funcZ (this->get_glyph_data, unicode, glyph); }
+    template <typename cache_t>
+    bool _cached_get (hb_codepoint_t  unicode,
+		      hb_codepoint_t *glyph,
+		      cache_t *cache) const
+    {
+      unsigned int v;
+      if (cache && cache->get (unicode, &v))
+      {
+	*glyph = v;
+	return true;
+      }
+      bool ret = this->get_glyph_funcZ (this->get_glyph_data, unicode, glyph);
+      if (cache && ret)
+	cache->set (unicode, *glyph);
+      return ret;
+    }
+
+    bool _cached_get_run (hb_codepoint_t  unicode,
+			  hb_codepoint_t *glyph,
+			  CmapGlyphRun   *run,
+			  void *cache HB_UNUSED) const
+    {
+      if (run->contains (unicode))
+      {
+	*glyph = run->get_glyph (unicode);
+	return *glyph;
+      }
+      return this->get_glyph_run_funcZ (this->get_glyph_data, unicode, glyph, run);
+    }
+    template <typename cache_t>
+    bool _cached_get_run (hb_codepoint_t  unicode,
+			  hb_codepoint_t *glyph,
+			  CmapGlyphRun   *run,
+			  cache_t *cache) const
+    {
+      /* A cache hit is cheaper still than checking the run. */
+      unsigned int v;
+      if (cache && cache->get (unicode, &v))
+      {
+	*glyph = v;
+	return true;
+      }
+      bool ret;
+      if (run->contains (unicode))
+      {
+	*glyph = run->get_glyph (unicode);
+	ret = *glyph;
+      }
+      else
+	ret = this->get_glyph_run_funcZ (this->get_glyph_data, unicode, glyph, run);
+      if (cache && ret)
+	cache->set (unicode, *glyph);
+      return ret;
+    }
 
     template <typename Type>
     HB_INTERNAL static bool get_glyph_from (const void *obj,
@@ -1769,6 +1995,16 @@ struct cmap
       return typed_obj->get_glyph (codepoint, glyph);
     }
 
+    template <typename Type>
+    HB_INTERNAL static bool get_glyph_run_from (const void *obj,
+						hb_codepoint_t codepoint,
+						hb_codepoint_t *glyph,
+						CmapGlyphRun *run)
+    {
+      const Type *typed_obj = (const Type *) obj;
+      return typed_obj->get_glyph (codepoint, glyph, run);
+    }
+
     template <typename Type>
     HB_INTERNAL static bool get_glyph_from_symbol (const void *obj,
 						   hb_codepoint_t codepoint,
@@ -1796,10 +2032,14 @@ struct cmap
     hb_nonnull_ptr_t<const CmapSubtableFormat14> subtable_uvs;
 
     hb_cmap_get_glyph_func_t get_glyph_funcZ;
+    hb_cmap_get_glyph_run_func_t get_glyph_run_funcZ = nullptr;
     const void *get_glyph_data;
 
     CmapSubtableFormat4::accelerator_t format4_accel;
 
+    hb_vector_t<uint16_t> flat_pages;
+    hb_vector_t<uint16_t> flat_glyphs;
+
     public:
     hb_blob_ptr_t<cmap> table;
   };
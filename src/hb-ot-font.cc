@@ -30,6 +30,7 @@
 
 #include "hb-ot.h"
 
+#include "hb-cache.hh"
 #include "hb-font.hh"
 #include "hb-machinery.hh"
 #include "hb-ot-face.hh"
@@ -59,6 +60,357 @@
  **/
 
 
+/* The cmap cache is shared between all fonts of a face, and
+ * is hung off the face as user-data. */
+typedef hb_cmap_cache_t hb_ot_font_cmap_cache_t;
+
+/* Hit/miss counters are per font, and only kept once asked for
+ * with hb_ot_font_set_cmap_cache_stats_enabled(); lookups through
+ * fonts that don't count never touch them. */
+struct hb_ot_font_cmap_stats_t
+{
+  hb_atomic_int_t hits;
+  hb_atomic_int_t misses;
+};
+
+/* Stands in for the cmap cache when the font counts its lookups. */
+struct hb_ot_font_counting_cmap_cache_t
+{
+  bool get (unsigned int key, unsigned int *value) const
+  {
+    if (cache && cache->get (key, value))
+    {
+      stats->hits.inc ();
+      return true;
+    }
+    stats->misses.inc ();
+    return false;
+  }
+  bool set (unsigned int key, unsigned int value)
+  { return cache && cache->set (key, value); }
+
+  hb_ot_font_cmap_cache_t *cache;
+  hb_ot_font_cmap_stats_t *stats;
+};
+
+static hb_user_data_key_t hb_ot_font_cmap_cache_user_data_key;
+
+/* Advances are cached in font units, with variations applied; they
+ * only need flushing when the variation coordinates change.  Scaling
+ * them is a single multiply, so we do that on every call instead of
+ * invalidating on hb_font_set_scale(). */
+struct hb_ot_font_advance_cache_t : hb_advance_cache_t
+{
+  void init () { hb_advance_cache_t::init (); cached_coords_serial.set_relaxed (0); }
+
+  void check_serial (const hb_font_t *font)
+  {
+    if (cached_coords_serial.get () != (int) font->serial_coords)
+    {
+      clear ();
+      cached_coords_serial.set (font->serial_coords);
+    }
+  }
+
+  hb_atomic_int_t cached_coords_serial;
+};
+
+/* Extents are cached scaled, as the glyph tables return them.  Nearly
+ * any font setting (scale, variations, synthetic slant, ...) affects
+ * them, so each entry records the font serial it was computed for, and
+ * only matches while that is current.  Entries don't fit in an atomic
+ * int like the caches above do, so each is guarded by a sequence number
+ * instead: lookups take no lock, and simply miss if the entry is being
+ * written.  Only writes, which follow loading the glyph anyway, take the
+ * lock, to keep writers from interleaving. */
+struct hb_ot_font_extents_cache_t
+{
+  void init ()
+  {
+    lock.init ();
+    for (unsigned i = 0; i < ARRAY_LENGTH (entries); i++)
+    {
+      entries[i].seq.set_relaxed (0);
+      entries[i].glyph.set_relaxed (-1);
+    }
+  }
+  void fini () { lock.fini (); }
+
+  bool get (const hb_font_t *font, hb_codepoint_t glyph, hb_glyph_extents_t *extents) const
+  {
+    const entry_t &entry = entries[glyph % ARRAY_LENGTH (entries)];
+    int seq = entry.seq.get ();
+    if (seq & 1)
+      return false; /* Being written. */
+    if ((hb_codepoint_t) entry.glyph.get_relaxed () != glyph ||
+	(unsigned) entry.serial.get_relaxed () != font->serial)
+      return false;
+    hb_glyph_extents_t e;
+    e.x_bearing = entry.x_bearing.get_relaxed ();
+    e.y_bearing = entry.y_bearing.get_relaxed ();
+    e.width = entry.width.get_relaxed ();
+    e.height = entry.height.get_relaxed ();
+    _hb_memory_r_barrier ();
+    if (entry.seq.get_relaxed () != seq)
+      return false; /* Overwritten meanwhile. */
+    *extents = e;
+    return true;
+  }
+
+  void set (const hb_font_t *font, hb_codepoint_t glyph, const hb_glyph_extents_t &extents)
+  {
+    hb_lock_t l (lock);
+    entry_t &entry = entries[glyph % ARRAY_LENGTH (entries)];
+    int seq = entry.seq.get_relaxed ();
+    entry.seq.set_relaxed (seq + 1);
+    _hb_memory_w_barrier ();
+    entry.glyph.set_relaxed (glyph);
+    entry.serial.set_relaxed (font->serial);
+    entry.x_bearing.set_relaxed (extents.x_bearing);
+    entry.y_bearing.set_relaxed (extents.y_bearing);
+    entry.width.set_relaxed (extents.width);
+    entry.height.set_relaxed (extents.height);
+    entry.seq.set (seq + 2);
+  }
+
+  private:
+  struct entry_t
+  {
+    hb_atomic_int_t seq; /* Odd while being written. */
+    hb_atomic_int_t glyph;
+    hb_atomic_int_t serial;
+    hb_atomic_int_t x_bearing;
+    hb_atomic_int_t y_bearing;
+    hb_atomic_int_t width;
+    hb_atomic_int_t height;
+  };
+
+  hb_mutex_t lock;
+  entry_t entries[256];
+};
+
+#ifndef HB_NO_CFF
+/* CFF and CFF2 outlines, recorded in font units so that only a change of
+ * variation coordinates invalidates them.  Off unless a budget is set with
+ * hb_ot_font_set_outline_cache_budget().  Entries are reference-counted,
+ * so that they are drawn without holding the lock; draw callbacks may
+ * well draw other glyphs of the same font. */
+struct hb_ot_font_outline_cache_t
+{
+  struct entry_t
+  {
+    hb_atomic_int_t ref_count;
+    CFF::cff_outline_t outline;
+  };
+
+  static entry_t *create_entry ()
+  {
+    entry_t *entry = (entry_t *) hb_calloc (1, sizeof (entry_t));
+    if (unlikely (!entry)) return nullptr;
+    entry = new (entry) entry_t ();
+    entry->ref_count.set_relaxed (1);
+    return entry;
+  }
+  static void release (entry_t *entry)
+  {
+    if (entry->ref_count.dec () != 1) return;
+    entry->~entry_t ();
+    hb_free (entry);
+  }
+
+  hb_ot_font_outline_cache_t (const hb_font_t *font, unsigned int budget_)
+  {
+    lock.init ();
+    serial_coords = font->serial_coords;
+    budget = budget_;
+  }
+  ~hb_ot_font_outline_cache_t ()
+  {
+    clear ();
+    lock.fini ();
+  }
+
+  /* Returns a reference the caller must release (), or nullptr. */
+  entry_t *get (const hb_font_t *font, hb_codepoint_t glyph)
+  {
+    hb_lock_t l (lock);
+    if (serial_coords != font->serial_coords)
+    {
+      clear ();
+      serial_coords = font->serial_coords;
+      return nullptr;
+    }
+    entry_t *entry = entries.get (glyph);
+    if (entry) entry->ref_count.inc ();
+    return entry;
+  }
+
+  void add (const hb_font_t *font, hb_codepoint_t glyph, entry_t *entry)
+  {
+    unsigned int entry_size = sizeof (entry_t) + entry->outline.get_size ();
+    if (entry_size > budget) return;
+
+    hb_lock_t l (lock);
+    if (serial_coords != font->serial_coords || entries.has (glyph)) return;
+    /* Rather than tracking recency, start over once full. */
+    if (size + entry_size > budget) clear ();
+    if (unlikely (!entries.set (glyph, entry))) return;
+    entry->ref_count.inc ();
+    size += entry_size;
+  }
+
+  private:
+  void clear ()
+  {
+    for (entry_t *entry : entries.values ())
+      release (entry);
+    entries.clear ();
+    size = 0;
+  }
+
+  hb_mutex_t lock;
+  unsigned int serial_coords;
+  unsigned int budget;
+  unsigned int size = 0;
+  hb_hashmap_t<hb_codepoint_t, entry_t *> entries;
+};
+#endif
+
+struct hb_ot_font_t
+{
+  const hb_ot_face_t *ot_face;
+
+  hb_ot_font_cmap_cache_t *cmap_cache;
+  hb_ot_font_cmap_stats_t *cmap_stats; /* See hb_ot_font_set_cmap_cache_stats_enabled(). */
+
+  mutable hb_ot_font_advance_cache_t h_advance_cache;
+#ifndef HB_NO_VERTICAL
+  mutable hb_ot_font_advance_cache_t v_advance_cache;
+#endif
+
+  /* Created on first use; most fonts never ask for extents. */
+  mutable hb_atomic_ptr_t<hb_ot_font_extents_cache_t> extents_cache;
+  bool extents_cache_disabled; /* See hb_ot_font_set_extents_cache_enabled(). */
+
+#ifndef HB_NO_CFF
+  hb_ot_font_outline_cache_t *outline_cache;
+#endif
+};
+
+template <typename accel_t>
+static inline unsigned int
+_hb_ot_font_get_advance_cached (const accel_t &mtx,
+				hb_font_t *font,
+				hb_ot_font_advance_cache_t *cache,
+				hb_codepoint_t glyph)
+{
+  unsigned int v;
+  if (cache->get (glyph, &v))
+    return v;
+  v = mtx.get_advance (glyph, font);
+  cache->set (glyph, v);
+  return v;
+}
+
+static hb_ot_font_t *
+_hb_ot_font_create (hb_font_t *font)
+{
+  hb_ot_font_t *ot_font = (hb_ot_font_t *) hb_calloc (1, sizeof (hb_ot_font_t));
+  if (unlikely (!ot_font))
+    return nullptr;
+
+  ot_font->ot_face = &font->face->table;
+
+  hb_face_t *face = font->face;
+  auto *cmap_cache = (hb_ot_font_cmap_cache_t *) hb_face_get_user_data (face,
+									 &hb_ot_font_cmap_cache_user_data_key);
+  if (!cmap_cache)
+  {
+    cmap_cache = (hb_ot_font_cmap_cache_t *) hb_malloc (sizeof (hb_ot_font_cmap_cache_t));
+    if (likely (cmap_cache))
+    {
+      cmap_cache->init ();
+      if (unlikely (!hb_face_set_user_data (face,
+					    &hb_ot_font_cmap_cache_user_data_key,
+					    cmap_cache,
+					    hb_free,
+					    false)))
+      {
+	/* Either another thread beat us to it, or the face is inert.
+	 * Use whatever is there now; nullptr just means uncached. */
+	hb_free (cmap_cache);
+	cmap_cache = (hb_ot_font_cmap_cache_t *) hb_face_get_user_data (face,
+									 &hb_ot_font_cmap_cache_user_data_key);
+      }
+    }
+  }
+  ot_font->cmap_cache = cmap_cache;
+
+  ot_font->h_advance_cache.init ();
+#ifndef HB_NO_VERTICAL
+  ot_font->v_advance_cache.init ();
+#endif
+
+  return ot_font;
+}
+
+static void
+_hb_ot_font_free_extents_cache (hb_ot_font_t *ot_font)
+{
+  hb_ot_font_extents_cache_t *extents_cache = ot_font->extents_cache.get ();
+  if (extents_cache)
+  {
+    extents_cache->fini ();
+    hb_free (extents_cache);
+    ot_font->extents_cache.set_relaxed (nullptr);
+  }
+}
+
+static void
+_hb_ot_font_destroy (void *font_data)
+{
+  hb_ot_font_t *ot_font = (hb_ot_font_t *) font_data;
+
+  _hb_ot_font_free_extents_cache (ot_font);
+  hb_free (ot_font->cmap_stats);
+
+#ifndef HB_NO_CFF
+  if (ot_font->outline_cache)
+  {
+    ot_font->outline_cache->~hb_ot_font_outline_cache_t ();
+    hb_free (ot_font->outline_cache);
+  }
+#endif
+
+  hb_free (ot_font);
+}
+
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+static hb_ot_font_extents_cache_t *
+_hb_ot_font_get_extents_cache (const hb_ot_font_t *ot_font)
+{
+  if (ot_font->extents_cache_disabled)
+    return nullptr;
+
+retry:
+  hb_ot_font_extents_cache_t *cache = ot_font->extents_cache.get ();
+  if (likely (cache))
+    return cache;
+
+  cache = (hb_ot_font_extents_cache_t *) hb_malloc (sizeof (hb_ot_font_extents_cache_t));
+  if (unlikely (!cache))
+    return nullptr;
+  cache->init ();
+  if (unlikely (!ot_font->extents_cache.cmpexch (nullptr, cache)))
+  {
+    cache->fini ();
+    hb_free (cache);
+    goto retry;
+  }
+  return cache;
+}
+#endif
+
 static hb_bool_t
 hb_ot_get_nominal_glyph (hb_font_t *font HB_UNUSED,
 			 void *font_data,
@@ -66,8 +418,14 @@ hb_ot_get_nominal_glyph (hb_font_t *font HB_UNUSED,
 			 hb_codepoint_t *glyph,
 			 void *user_data HB_UNUSED)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
-  return ot_face->cmap->get_nominal_glyph (unicode, glyph);
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
+  if (unlikely (ot_font->cmap_stats))
+  {
+    hb_ot_font_counting_cmap_cache_t cache = {ot_font->cmap_cache, ot_font->cmap_stats};
+    return ot_face->cmap->get_nominal_glyph (unicode, glyph, &cache);
+  }
+  return ot_face->cmap->get_nominal_glyph (unicode, glyph, ot_font->cmap_cache);
 }
 
 static unsigned int
@@ -80,10 +438,20 @@ hb_ot_get_nominal_glyphs (hb_font_t *font HB_UNUSED,
 			  unsigned int glyph_stride,
 			  void *user_data HB_UNUSED)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
+  if (unlikely (ot_font->cmap_stats))
+  {
+    hb_ot_font_counting_cmap_cache_t cache = {ot_font->cmap_cache, ot_font->cmap_stats};
+    return ot_face->cmap->get_nominal_glyphs (count,
+					      first_unicode, unicode_stride,
+					      first_glyph, glyph_stride,
+					      &cache);
+  }
   return ot_face->cmap->get_nominal_glyphs (count,
 					    first_unicode, unicode_stride,
-					    first_glyph, glyph_stride);
+					    first_glyph, glyph_stride,
+					    ot_font->cmap_cache);
 }
 
 static hb_bool_t
@@ -94,7 +462,8 @@ hb_ot_get_variation_glyph (hb_font_t *font HB_UNUSED,
 			   hb_codepoint_t *glyph,
 			   void *user_data HB_UNUSED)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
   return ot_face->cmap->get_variation_glyph (unicode, variation_selector, glyph);
 }
 
@@ -107,9 +476,26 @@ hb_ot_get_glyph_h_advances (hb_font_t* font, void* font_data,
 			    unsigned advance_stride,
 			    void *user_data HB_UNUSED)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
   const OT::hmtx_accelerator_t &hmtx = *ot_face->hmtx;
 
+#if !defined(HB_NO_VAR) && !defined(HB_NO_OT_FONT_ADVANCE_CACHE)
+  /* Static advances are a plain array lookup; only cache the varied ones. */
+  if (font->num_coords)
+  {
+    hb_ot_font_advance_cache_t *cache = &ot_font->h_advance_cache;
+    cache->check_serial (font);
+    for (unsigned int i = 0; i < count; i++)
+    {
+      *first_advance = font->em_scale_x (_hb_ot_font_get_advance_cached (hmtx, font, cache, *first_glyph));
+      first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
+      first_advance = &StructAtOffsetUnaligned<hb_position_t> (first_advance, advance_stride);
+    }
+    return;
+  }
+#endif
+
   for (unsigned int i = 0; i < count; i++)
   {
     *first_advance = font->em_scale_x (hmtx.get_advance (*first_glyph, font));
@@ -128,9 +514,25 @@ hb_ot_get_glyph_v_advances (hb_font_t* font, void* font_data,
 			    unsigned advance_stride,
 			    void *user_data HB_UNUSED)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
   const OT::vmtx_accelerator_t &vmtx = *ot_face->vmtx;
 
+#if !defined(HB_NO_VAR) && !defined(HB_NO_OT_FONT_ADVANCE_CACHE)
+  if (font->num_coords)
+  {
+    hb_ot_font_advance_cache_t *cache = &ot_font->v_advance_cache;
+    cache->check_serial (font);
+    for (unsigned int i = 0; i < count; i++)
+    {
+      *first_advance = font->em_scale_y (-(int) _hb_ot_font_get_advance_cached (vmtx, font, cache, *first_glyph));
+      first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
+      first_advance = &StructAtOffsetUnaligned<hb_position_t> (first_advance, advance_stride);
+    }
+    return;
+  }
+#endif
+
   for (unsigned int i = 0; i < count; i++)
   {
     *first_advance = font->em_scale_y (-(int) vmtx.get_advance (*first_glyph, font));
@@ -149,7 +551,8 @@ hb_ot_get_glyph_v_origin (hb_font_t *font,
 			  hb_position_t *y,
 			  void *user_data HB_UNUSED)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
 
   *x = font->get_glyph_h_advance (glyph) / 2;
 
@@ -177,6 +580,20 @@ hb_ot_get_glyph_v_origin (hb_font_t *font,
 }
 #endif
 
+static bool
+_hb_ot_get_outline_extents (hb_font_t *font,
+			    const hb_ot_face_t *ot_face,
+			    hb_codepoint_t glyph,
+			    hb_glyph_extents_t *extents)
+{
+  if (ot_face->glyf->get_extents (font, glyph, extents)) return true;
+#ifndef HB_NO_OT_FONT_CFF
+  if (ot_face->cff1->get_extents (font, glyph, extents)) return true;
+  if (ot_face->cff2->get_extents (font, glyph, extents)) return true;
+#endif
+  return false;
+}
+
 static hb_bool_t
 hb_ot_get_glyph_extents (hb_font_t *font,
 			 void *font_data,
@@ -184,15 +601,24 @@ hb_ot_get_glyph_extents (hb_font_t *font,
 			 hb_glyph_extents_t *extents,
 			 void *user_data HB_UNUSED)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
 
 #if !defined(HB_NO_OT_FONT_BITMAP) && !defined(HB_NO_COLOR)
   if (ot_face->sbix->get_extents (font, glyph, extents)) return true;
 #endif
-  if (ot_face->glyf->get_extents (font, glyph, extents)) return true;
-#ifndef HB_NO_OT_FONT_CFF
-  if (ot_face->cff1->get_extents (font, glyph, extents)) return true;
-  if (ot_face->cff2->get_extents (font, glyph, extents)) return true;
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+  /* Outline extents mean loading, and for CFF interpreting, the glyph;
+   * layout engines ask for the same glyphs over and over. */
+  hb_ot_font_extents_cache_t *cache = _hb_ot_font_get_extents_cache (ot_font);
+  if (cache && cache->get (font, glyph, extents)) return true;
+  if (_hb_ot_get_outline_extents (font, ot_face, glyph, extents))
+  {
+    if (cache) cache->set (font, glyph, *extents);
+    return true;
+  }
+#else
+  if (_hb_ot_get_outline_extents (font, ot_face, glyph, extents)) return true;
 #endif
 #if !defined(HB_NO_OT_FONT_BITMAP) && !defined(HB_NO_COLOR)
   if (ot_face->CBDT->get_extents (font, glyph, extents)) return true;
@@ -210,7 +636,8 @@ hb_ot_get_glyph_name (hb_font_t *font HB_UNUSED,
 		      char *name, unsigned int size,
 		      void *user_data HB_UNUSED)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
   if (ot_face->post->get_glyph_name (glyph, name, size)) return true;
 #ifndef HB_NO_OT_FONT_CFF
   if (ot_face->cff1->get_glyph_name (glyph, name, size)) return true;
@@ -224,7 +651,8 @@ hb_ot_get_glyph_from_name (hb_font_t *font HB_UNUSED,
 			   hb_codepoint_t *glyph,
 			   void *user_data HB_UNUSED)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
   if (ot_face->post->get_glyph_from_name (name, len, glyph)) return true;
 #ifndef HB_NO_OT_FONT_CFF
     if (ot_face->cff1->get_glyph_from_name (name, len, glyph)) return true;
@@ -258,9 +686,43 @@ hb_ot_get_font_v_extents (hb_font_t *font,
 #endif
 
 #ifndef HB_NO_DRAW
+#ifndef HB_NO_CFF
+static bool
+_hb_ot_get_cff_path_cached (hb_font_t *font,
+			    hb_ot_font_outline_cache_t *cache,
+			    hb_codepoint_t glyph,
+			    hb_draw_session_t &draw_session)
+{
+  hb_ot_font_outline_cache_t::entry_t *entry = cache->get (font, glyph);
+  if (!entry)
+  {
+    entry = hb_ot_font_outline_cache_t::create_entry ();
+    if (unlikely (!entry)) return false;
+    CFF::cff_outline_t &outline = entry->outline;
+    bool ret = font->face->table.cff1->get_outline (font, glyph, outline);
+    if (!ret)
+    {
+      outline.ops.resize (0);
+      outline.coords.resize (0);
+      ret = font->face->table.cff2->get_outline (font, glyph, outline);
+    }
+    if (!ret)
+    {
+      hb_ot_font_outline_cache_t::release (entry);
+      return false;
+    }
+    cache->add (font, glyph, entry);
+  }
+
+  entry->outline.replay (font, draw_session);
+  hb_ot_font_outline_cache_t::release (entry);
+  return true;
+}
+#endif
+
 static void
 hb_ot_get_glyph_shape (hb_font_t *font,
-		       void *font_data HB_UNUSED,
+		       void *font_data,
 		       hb_codepoint_t glyph,
 		       hb_draw_funcs_t *draw_funcs, void *draw_data,
 		       void *user_data)
@@ -268,6 +730,9 @@ hb_ot_get_glyph_shape (hb_font_t *font,
   hb_draw_session_t draw_session (draw_funcs, draw_data, font->slant_xy);
   if (font->face->table.glyf->get_path (font, glyph, draw_session)) return;
 #ifndef HB_NO_CFF
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  if (ot_font->outline_cache &&
+      _hb_ot_get_cff_path_cached (font, ot_font->outline_cache, glyph, draw_session)) return;
   if (font->face->table.cff1->get_path (font, glyph, draw_session)) return;
   if (font->face->table.cff2->get_path (font, glyph, draw_session)) return;
 #endif
@@ -340,10 +805,160 @@ _hb_ot_get_font_funcs ()
 void
 hb_ot_font_set_funcs (hb_font_t *font)
 {
+  hb_ot_font_t *ot_font = _hb_ot_font_create (font);
+  if (unlikely (!ot_font))
+    return;
+
   hb_font_set_funcs (font,
 		     _hb_ot_get_font_funcs (),
-		     &font->face->table,
-		     nullptr);
+		     ot_font,
+		     _hb_ot_font_destroy);
+}
+
+/**
+ * hb_ot_font_set_cmap_cache_stats_enabled:
+ * @font: #hb_font_t to work upon
+ * @enabled: Whether to count cmap cache hits and misses
+ *
+ * Sets whether the OpenType font functions count how many of the
+ * nominal-glyph lookups of @font are served from the cmap cache.
+ * Counting is off by default.  Turning it on resets the counts to
+ * zero; see hb_ot_font_get_cmap_cache_stats().
+ *
+ * This must be called before @font is used from multiple threads.
+ *
+ * Return value: `true` if @font uses the OpenType font functions
+ * and the setting was applied, `false` otherwise.
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_ot_font_set_cmap_cache_stats_enabled (hb_font_t *font,
+					 hb_bool_t  enabled)
+{
+  if (hb_object_is_immutable (font) || font->klass != _hb_ot_get_font_funcs ())
+    return false;
+
+  hb_ot_font_t *ot_font = (hb_ot_font_t *) font->user_data;
+  hb_free (ot_font->cmap_stats);
+  ot_font->cmap_stats = nullptr;
+  if (!enabled)
+    return true;
+
+  ot_font->cmap_stats = (hb_ot_font_cmap_stats_t *) hb_calloc (1, sizeof (hb_ot_font_cmap_stats_t));
+  return ot_font->cmap_stats != nullptr;
+}
+
+/**
+ * hb_ot_font_get_cmap_cache_stats:
+ * @font: #hb_font_t to work upon
+ * @hits: (out) (optional): Number of nominal-glyph lookups served from the cache
+ * @misses: (out) (optional): Number of nominal-glyph lookups that went to the cmap table
+ *
+ * Fetches the hit and miss counts of the cmap cache used by the
+ * OpenType font functions.  The cache itself is shared by all fonts
+ * created on the same face, but the counts are kept per font, and
+ * only while enabled with hb_ot_font_set_cmap_cache_stats_enabled();
+ * otherwise both are zero.  Lookups answered from a flattened cmap (see
+ * hb_face_set_cmap_accelerator_budget()) do not go through the cache,
+ * and are not counted.
+ *
+ * Return value: `true` if @font uses the OpenType font functions
+ * and has a cmap cache, `false` otherwise.
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_ot_font_get_cmap_cache_stats (hb_font_t    *font,
+				 unsigned int *hits,   /* OUT */
+				 unsigned int *misses  /* OUT */)
+{
+  const hb_ot_font_t *ot_font = nullptr;
+  if (font->klass == _hb_ot_get_font_funcs ())
+    ot_font = (const hb_ot_font_t *) font->user_data;
+
+  const hb_ot_font_cmap_stats_t *stats = ot_font ? ot_font->cmap_stats : nullptr;
+  if (hits) *hits = stats ? (unsigned) stats->hits.get_relaxed () : 0;
+  if (misses) *misses = stats ? (unsigned) stats->misses.get_relaxed () : 0;
+  return ot_font && ot_font->cmap_cache;
+}
+
+/**
+ * hb_ot_font_set_outline_cache_budget:
+ * @font: #hb_font_t to work upon
+ * @budget: Memory, in bytes, the cache may use; zero turns it off
+ *
+ * Sets how much memory the OpenType font functions may spend caching
+ * CFF and CFF2 glyph outlines of @font.  A cached glyph is drawn again
+ * without interpreting its charstring, which helps clients that draw
+ * the same glyphs over and over.  The cached outlines are independent
+ * of the font scale; they are dropped when the variation coordinates
+ * of @font change.  The cache is off by default.
+ *
+ * This must be called before @font is used from multiple threads.
+ *
+ * Return value: `true` if @font uses the OpenType font functions
+ * and the budget was set, `false` otherwise.
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_ot_font_set_outline_cache_budget (hb_font_t    *font,
+				     unsigned int  budget)
+{
+#ifndef HB_NO_CFF
+  if (hb_object_is_immutable (font) || font->klass != _hb_ot_get_font_funcs ())
+    return false;
+
+  hb_ot_font_t *ot_font = (hb_ot_font_t *) font->user_data;
+  if (ot_font->outline_cache)
+  {
+    ot_font->outline_cache->~hb_ot_font_outline_cache_t ();
+    hb_free (ot_font->outline_cache);
+    ot_font->outline_cache = nullptr;
+  }
+  if (!budget)
+    return true;
+
+  auto *cache = (hb_ot_font_outline_cache_t *) hb_calloc (1, sizeof (hb_ot_font_outline_cache_t));
+  if (unlikely (!cache))
+    return false;
+  ot_font->outline_cache = new (cache) hb_ot_font_outline_cache_t (font, budget);
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * hb_ot_font_set_extents_cache_enabled:
+ * @font: #hb_font_t to work upon
+ * @enabled: Whether to cache glyph extents
+ *
+ * Sets whether the OpenType font functions cache the outline extents
+ * of the glyphs of @font, which saves loading a glyph again every time
+ * its extents are asked for.  The cache takes a few kilobytes per font
+ * and is on by default; turning it off frees it.
+ *
+ * This must be called before @font is used from multiple threads.
+ *
+ * Return value: `true` if @font uses the OpenType font functions,
+ * `false` otherwise.
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_ot_font_set_extents_cache_enabled (hb_font_t *font,
+				      hb_bool_t  enabled)
+{
+  if (hb_object_is_immutable (font) || font->klass != _hb_ot_get_font_funcs ())
+    return false;
+
+  hb_ot_font_t *ot_font = (hb_ot_font_t *) font->user_data;
+  ot_font->extents_cache_disabled = !enabled;
+  if (!enabled)
+    _hb_ot_font_free_extents_cache (ot_font);
+  return true;
 }
 
 #ifndef HB_NO_VAR
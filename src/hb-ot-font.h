@@ -39,6 +39,23 @@ HB_BEGIN_DECLS
 HB_EXTERN void
 hb_ot_font_set_funcs (hb_font_t *font);
 
+HB_EXTERN hb_bool_t
+hb_ot_font_set_cmap_cache_stats_enabled (hb_font_t *font,
+					 hb_bool_t  enabled);
+
+HB_EXTERN hb_bool_t
+hb_ot_font_get_cmap_cache_stats (hb_font_t    *font,
+				 unsigned int *hits,   /* OUT */
+				 unsigned int *misses  /* OUT */);
+
+HB_EXTERN hb_bool_t
+hb_ot_font_set_outline_cache_budget (hb_font_t    *font,
+				     unsigned int  budget);
+
+HB_EXTERN hb_bool_t
+hb_ot_font_set_extents_cache_enabled (hb_font_t *font,
+				      hb_bool_t  enabled);
+
 
 HB_END_DECLS
 
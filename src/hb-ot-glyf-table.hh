@@ -35,6 +35,7 @@
 #include "hb-ot-hmtx-table.hh"
 #include "hb-ot-var-gvar-table.hh"
 #include "hb-draw.hh"
+#include "hb-pool.hh"
 
 namespace OT {
 
@@ -319,7 +320,7 @@ struct glyf
       }
     }
 
-    void transform_points (contour_point_vector_t &points) const
+    void transform_points (hb_array_t<contour_point_t> points) const
     {
       float matrix[4];
       contour_point_t trans;
@@ -327,17 +328,33 @@ struct glyf
       {
 	if (scaled_offsets ())
 	{
-	  points.translate (trans);
-	  points.transform (matrix);
+	  translate_points (points, trans);
+	  transform_points (points, matrix);
 	}
 	else
 	{
-	  points.transform (matrix);
-	  points.translate (trans);
+	  transform_points (points, matrix);
+	  translate_points (points, trans);
 	}
       }
     }
 
+    static void translate_points (hb_array_t<contour_point_t> points, const contour_point_t &delta)
+    {
+      for (contour_point_t &p : points)
+	p.translate (delta);
+    }
+
+    static void transform_points (hb_array_t<contour_point_t> points, const float (&matrix)[4])
+    {
+      for (contour_point_t &p : points)
+      {
+	float x_ = p.x * matrix[0] + p.y * matrix[2];
+	     p.y = p.x * matrix[1] + p.y * matrix[3];
+	p.x = x_;
+      }
+    }
+
     protected:
     bool scaled_offsets () const
     { return (flags & (SCALED_COMPONENT_OFFSET | UNSCALED_COMPONENT_OFFSET)) == SCALED_COMPONENT_OFFSET; }
@@ -599,7 +616,7 @@ struct glyf
       }
 
       static bool read_points (const HBUINT8 *&p /* IN/OUT */,
-			       contour_point_vector_t &points_ /* IN/OUT */,
+			       hb_array_t<contour_point_t> points_ /* IN/OUT */,
 			       const hb_bytes_t &bytes,
 			       void (* setter) (contour_point_t &_, float v),
 			       const simple_glyph_flag_t short_flag,
@@ -631,7 +648,8 @@ struct glyf
 	return true;
       }
 
-      bool get_contour_points (contour_point_vector_t &points_ /* OUT */,
+      /* Appends the glyph's points to all_points. */
+      bool get_contour_points (contour_point_vector_t &all_points /* IN/OUT */,
 			       bool phantom_only = false) const
       {
 	const HBUINT16 *endPtsOfContours = &StructAfter<HBUINT16> (header);
@@ -639,7 +657,9 @@ struct glyf
 	if (unlikely (!bytes.check_range (&endPtsOfContours[num_contours + 1]))) return false;
 	unsigned int num_points = endPtsOfContours[num_contours - 1] + 1;
 
-	points_.resize (num_points);
+	unsigned int old_length = all_points.length;
+	if (unlikely (!all_points.resize (old_length + num_points))) return false;
+	hb_array_t<contour_point_t> points_ = all_points.as_array ().sub_array (old_length);
 	for (unsigned int i = 0; i < points_.length; i++) points_[i].init ();
 	if (phantom_only) return true;
 
@@ -765,36 +785,47 @@ struct glyf
     }
 
     /* Note: Recursively calls itself.
-     * all_points includes phantom points
+     * Appends the glyph's points, then its phantom points, to all_points.
+     * Component offsets of composite glyphs are kept on the scratch
+     * stack meanwhile; both vectors are left as large as they grew, so
+     * that callers can reuse them without allocating again.
      */
     bool get_points (hb_font_t *font, const accelerator_t &glyf_accelerator,
-		     contour_point_vector_t &all_points /* OUT */,
+		     contour_point_vector_t &all_points /* IN/OUT */,
+		     contour_point_vector_t &scratch,
 		     bool phantom_only = false,
 		     unsigned int depth = 0) const
     {
       if (unlikely (depth > HB_MAX_NESTING_LEVEL)) return false;
-      contour_point_vector_t points;
+
+      /* Our own points start here; this is also where anchor point
+       * numbers of our components count from. */
+      unsigned int start = all_points.length;
+      /* Composite glyphs keep their pseudo component points, and
+       * their phantom points, on the scratch stack. */
+      unsigned int scratch_start = scratch.length;
+      contour_point_vector_t &points = type == COMPOSITE ? scratch : all_points;
 
       switch (type) {
       case COMPOSITE:
       {
 	/* pseudo component points for each component in composite glyph */
 	unsigned num_points = hb_len (CompositeGlyph (*header, bytes).get_iterator ());
-	if (unlikely (!points.resize (num_points))) return false;
-	for (unsigned i = 0; i < points.length; i++)
-	  points[i].init ();
+	if (unlikely (!scratch.resize (scratch_start + num_points))) return false;
+	for (unsigned i = scratch_start; i < scratch.length; i++)
+	  scratch[i].init ();
 	break;
       }
       case SIMPLE:
-	if (unlikely (!SimpleGlyph (*header, bytes).get_contour_points (points, phantom_only)))
+	if (unlikely (!SimpleGlyph (*header, bytes).get_contour_points (all_points, phantom_only)))
 	  return false;
 	break;
       }
 
       /* Init phantom points */
       if (unlikely (!points.resize (points.length + PHANTOM_COUNT))) return false;
-      hb_array_t<contour_point_t> phantoms = points.sub_array (points.length - PHANTOM_COUNT, PHANTOM_COUNT);
       {
+	hb_array_t<contour_point_t> phantoms = points.sub_array (points.length - PHANTOM_COUNT, PHANTOM_COUNT);
 	for (unsigned i = 0; i < PHANTOM_COUNT; ++i) phantoms[i].init ();
 	int h_delta = (int) header->xMin -
 		      glyf_accelerator.hmtx->get_side_bearing (gid);
@@ -820,60 +851,61 @@ struct glyf
       }
 
 #ifndef HB_NO_VAR
-      if (unlikely (!glyf_accelerator.gvar->apply_deltas_to_points (gid, font, points.as_array ())))
-	return false;
+      {
+	unsigned int points_start = type == COMPOSITE ? scratch_start : start;
+	if (unlikely (!glyf_accelerator.gvar->apply_deltas_to_points (gid, font, points.as_array ().sub_array (points_start))))
+	  return false;
+      }
 #endif
 
-      switch (type) {
-      case SIMPLE:
-	all_points.extend (points.as_array ());
-	break;
-      case COMPOSITE:
+      if (type == COMPOSITE)
       {
+	unsigned int phantoms_start = scratch.length - PHANTOM_COUNT;
 	unsigned int comp_index = 0;
 	for (auto &item : get_composite_iterator ())
 	{
-	  contour_point_vector_t comp_points;
+	  /* Components append their points, phantoms last, after ours. */
+	  unsigned int comp_start = all_points.length;
 	  if (unlikely (!glyf_accelerator.glyph_for_gid (item.get_glyph_index ())
-					 .get_points (font, glyf_accelerator, comp_points,
-			 			      phantom_only, depth + 1)
-			|| comp_points.length < PHANTOM_COUNT))
+					 .get_points (font, glyf_accelerator, all_points, scratch,
+						      phantom_only, depth + 1)
+			|| all_points.length - comp_start < PHANTOM_COUNT))
 	    return false;
+	  hb_array_t<contour_point_t> comp_points = all_points.as_array ().sub_array (comp_start);
 
 	  /* Copy phantom points from component if USE_MY_METRICS flag set */
 	  if (item.is_use_my_metrics ())
 	    for (unsigned int i = 0; i < PHANTOM_COUNT; i++)
-	      phantoms[i] = comp_points[comp_points.length - PHANTOM_COUNT + i];
+	      scratch[phantoms_start + i] = comp_points[comp_points.length - PHANTOM_COUNT + i];
 
 	  /* Apply component transformation & translation */
 	  item.transform_points (comp_points);
 
 	  /* Apply translation from gvar */
-	  comp_points.translate (points[comp_index]);
+	  CompositeGlyphChain::translate_points (comp_points, scratch[scratch_start + comp_index]);
 
 	  if (item.is_anchored ())
 	  {
 	    unsigned int p1, p2;
 	    item.get_anchor_points (p1, p2);
-	    if (likely (p1 < all_points.length && p2 < comp_points.length))
+	    if (likely (p1 < comp_start - start && p2 < comp_points.length))
 	    {
 	      contour_point_t delta;
-	      delta.init (all_points[p1].x - comp_points[p2].x,
-			  all_points[p1].y - comp_points[p2].y);
+	      delta.init (all_points[start + p1].x - comp_points[p2].x,
+			  all_points[start + p1].y - comp_points[p2].y);
 
-	      comp_points.translate (delta);
+	      CompositeGlyphChain::translate_points (comp_points, delta);
 	    }
 	  }
 
-	  all_points.extend (comp_points.sub_array (0, comp_points.length - PHANTOM_COUNT));
+	  /* Drop the component's phantom points. */
+	  all_points.shrink (all_points.length - PHANTOM_COUNT);
 
 	  comp_index++;
 	}
 
-	all_points.extend (phantoms);
-      } break;
-      default:
-	all_points.extend (phantoms);
+	all_points.extend (scratch.sub_array (phantoms_start, PHANTOM_COUNT));
+	scratch.shrink (scratch_start);
       }
 
       if (depth == 0) /* Apply at top level */
@@ -882,11 +914,11 @@ struct glyf
 	 * Shift points horizontally by the updated left side bearing
 	 */
 	contour_point_t delta;
-	delta.init (-phantoms[PHANTOM_LEFT].x, 0.f);
-	if (delta.x) all_points.translate (delta);
+	delta.init (-all_points[all_points.length - PHANTOM_COUNT + PHANTOM_LEFT].x, 0.f);
+	if (delta.x) CompositeGlyphChain::translate_points (all_points.as_array ().sub_array (start), delta);
       }
 
-      return true;
+      return !all_points.in_error ();
     }
 
     bool get_extents (hb_font_t *font, const accelerator_t &glyf_accelerator,
@@ -951,23 +983,49 @@ struct glyf
     }
     ~accelerator_t ()
     {
+      scratch_pool.fini ();
       glyf_table.destroy ();
     }
 
     protected:
+    /* Point storage reused across get_points() calls, so that loading
+     * glyphs, composite ones included, doesn't allocate once warmed up. */
+    struct scratch_t
+    {
+      /* Don't hold on to what one huge glyph needed for the lifetime
+       * of the face. */
+      void trim ()
+      {
+	if (all_points.get_allocated () > max_kept_points) all_points.fini ();
+	if (comp_points.get_allocated () > max_kept_points) comp_points.fini ();
+      }
+      static constexpr unsigned max_kept_points = 4096;
+
+      contour_point_vector_t all_points;
+      contour_point_vector_t comp_points;
+    };
+
     template<typename T>
     bool get_points (hb_font_t *font, hb_codepoint_t gid, T consumer) const
     {
       if (gid >= num_glyphs) return false;
 
-      /* Making this allocfree is not that easy
-	 https://github.com/harfbuzz/harfbuzz/issues/2095
-	 mostly because of gvar handling in VF fonts,
-	 perhaps a separate path for non-VF fonts can be considered */
-      contour_point_vector_t all_points;
+      scratch_t *scratch = scratch_pool.acquire ();
+      if (unlikely (!scratch)) return false;
+      bool ret = get_points (font, gid, consumer, *scratch);
+      scratch_pool.release (scratch);
+      return ret;
+    }
+
+    template<typename T>
+    bool get_points (hb_font_t *font, hb_codepoint_t gid, T consumer, scratch_t &scratch) const
+    {
+      contour_point_vector_t &all_points = scratch.all_points;
+      all_points.resize (0);
+      scratch.comp_points.resize (0);
 
       bool phantom_only = !consumer.is_consuming_contour_points ();
-      if (unlikely (!glyph_for_gid (gid).get_points (font, *this, all_points, phantom_only)))
+      if (unlikely (!glyph_for_gid (gid).get_points (font, *this, all_points, scratch.comp_points, phantom_only)))
 	return false;
 
       if (consumer.is_consuming_contour_points ())
@@ -1285,6 +1343,7 @@ struct glyf
     unsigned int num_glyphs;
     hb_blob_ptr_t<loca> loca_table;
     hb_blob_ptr_t<glyf> glyf_table;
+    hb_single_pool_t<scratch_t> scratch_pool;
   };
 
   struct SubsetGlyph
@@ -2605,6 +2605,39 @@ struct VarRegionList
     return v;
   }
 
+  /* Returns the scalars of all regions, evaluated at the coordinates
+   * of @font.  They are computed once and kept on the font until its
+   * coordinates change.  Returns nullptr on allocation failure. */
+  const float *get_scalars (hb_font_t *font) const
+  {
+    hb_font_t::var_region_scalars_t *head = font->var_region_scalars.get ();
+    for (hb_font_t::var_region_scalars_t *node = head; node; node = node->next)
+      if (node->regions == this)
+	return node->scalars;
+
+    unsigned int count = regionCount;
+    hb_font_t::var_region_scalars_t *node;
+    node = (hb_font_t::var_region_scalars_t *) hb_malloc (sizeof (*node) + count * sizeof (float));
+    if (unlikely (!node))
+      return nullptr;
+
+    node->regions = this;
+    node->scalars = (float *) (node + 1);
+    for (unsigned int i = 0; i < count; i++)
+      node->scalars[i] = evaluate (i, font->coords, font->num_coords);
+
+    /* Another thread might have added the same regions in the meantime;
+     * a duplicate node is harmless. */
+    do
+      node->next = head = font->var_region_scalars.get ();
+    while (unlikely (!font->var_region_scalars.cmpexch (head, node)));
+
+    return node->scalars;
+  }
+
+  float get_scalar (unsigned int region_index, const float *scalars) const
+  { return likely (region_index < regionCount) ? scalars[region_index] : 0.f; }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -2689,6 +2722,34 @@ struct VarData
    return delta;
   }
 
+  /* Same as above, with all region scalars precomputed
+   * by VarRegionList::get_scalars(). */
+  float get_delta (unsigned int inner,
+		   const float *region_scalars,
+		   const VarRegionList &regions) const
+  {
+    if (unlikely (inner >= itemCount))
+      return 0.;
+
+   unsigned int count = regionIndices.len;
+   unsigned int scount = shortCount;
+
+   const HBUINT8 *bytes = get_delta_bytes ();
+   const HBUINT8 *row = bytes + inner * (scount + count);
+
+   float delta = 0.;
+   unsigned int i = 0;
+
+   const HBINT16 *scursor = reinterpret_cast<const HBINT16 *> (row);
+   for (; i < scount; i++)
+     delta += regions.get_scalar (regionIndices.arrayZ[i], region_scalars) * *scursor++;
+   const HBINT8 *bcursor = reinterpret_cast<const HBINT8 *> (scursor);
+   for (; i < count; i++)
+     delta += regions.get_scalar (regionIndices.arrayZ[i], region_scalars) * *bcursor++;
+
+   return delta;
+  }
+
   void get_region_scalars (const int *coords, unsigned int coord_count,
 			   const VarRegionList &regions,
 			   float *scalars /*OUT */,
@@ -2852,6 +2913,29 @@ struct VariationStore
     return get_delta (outer, inner, coords, coord_count);
   }
 
+  float get_delta (unsigned int index, hb_font_t *font) const
+  {
+#ifdef HB_NO_VAR
+    return 0.f;
+#endif
+
+    unsigned int outer = index >> 16;
+    unsigned int inner = index & 0xFFFF;
+    if (unlikely (outer >= dataSets.len))
+      return 0.f;
+
+    /* Don't bother caching for fonts without variations set. */
+    if (!font->num_coords)
+      return get_delta (outer, inner, nullptr, 0);
+
+    const VarRegionList &regions = this+this->regions;
+    const float *scalars = regions.get_scalars (font);
+    if (unlikely (!scalars))
+      return get_delta (outer, inner, font->coords, font->num_coords);
+
+    return (this+dataSets[outer]).get_delta (inner, scalars, regions);
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
 #ifdef HB_NO_VAR
@@ -3483,7 +3567,7 @@ struct VariationDevice
 
   float get_delta (hb_font_t *font, const VariationStore &store) const
   {
-    return store.get_delta (varIdx, font->coords, font->num_coords);
+    return store.get_delta (varIdx, font);
   }
 
   protected:
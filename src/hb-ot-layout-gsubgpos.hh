@@ -640,6 +640,12 @@ struct hb_ot_apply_context_t :
 
   uint32_t random_state;
 
+  /* Superset of the glyphs in the buffer; kept up to date as glyphs
+   * are substituted, so whole lookups can be skipped if none of their
+   * glyphs is present.  Only hb_ot_map_t::apply() fills it in, as it
+   * takes a pass over the buffer; other users leave it empty. */
+  hb_set_digest_t digest;
+
 
   hb_ot_apply_context_t (unsigned int table_index_,
 			 hb_font_t *font_,
@@ -665,7 +671,11 @@ struct hb_ot_apply_context_t :
 			auto_zwnj (true),
 			auto_zwj (true),
 			random (false),
-			random_state (1) { init_iters (); }
+			random_state (1)
+  {
+    digest.init ();
+    init_iters ();
+  }
 
   void init_iters ()
   {
@@ -729,8 +739,10 @@ struct hb_ot_apply_context_t :
   void _set_glyph_class (hb_codepoint_t glyph_index,
 			  unsigned int class_guess = 0,
 			  bool ligature = false,
-			  bool component = false) const
+			  bool component = false)
   {
+    digest.add (glyph_index);
+
     unsigned int props = _hb_glyph_info_get_glyph_props (&buffer->cur());
     props |= HB_OT_LAYOUT_GLYPH_PROPS_SUBSTITUTED;
     if (ligature)
@@ -760,24 +772,24 @@ struct hb_ot_apply_context_t :
       _hb_glyph_info_set_glyph_props (&buffer->cur(), props);
   }
 
-  void replace_glyph (hb_codepoint_t glyph_index) const
+  void replace_glyph (hb_codepoint_t glyph_index)
   {
     _set_glyph_class (glyph_index);
     (void) buffer->replace_glyph (glyph_index);
   }
-  void replace_glyph_inplace (hb_codepoint_t glyph_index) const
+  void replace_glyph_inplace (hb_codepoint_t glyph_index)
   {
     _set_glyph_class (glyph_index);
     buffer->cur().codepoint = glyph_index;
   }
   void replace_glyph_with_ligature (hb_codepoint_t glyph_index,
-				    unsigned int class_guess) const
+				    unsigned int class_guess)
   {
     _set_glyph_class (glyph_index, class_guess, true);
     (void) buffer->replace_glyph (glyph_index);
   }
   void output_glyph_for_component (hb_codepoint_t glyph_index,
-				   unsigned int class_guess) const
+				   unsigned int class_guess)
   {
     _set_glyph_class (glyph_index, class_guess, false, true);
     (void) buffer->output_glyph (glyph_index);
@@ -800,23 +812,69 @@ struct hb_get_subtables_context_t :
   struct hb_applicable_t
   {
     template <typename T>
-    void init (const T &obj_, hb_apply_func_t apply_func_)
+    void init (const T &obj_, hb_apply_func_t apply_func_,
+	       unsigned int *coverage_budget)
     {
       obj = &obj_;
       apply_func = apply_func_;
       digest.init ();
       obj_.get_coverage ().collect_coverage (&digest);
+
+      coverage_start = 0;
+      coverage_words = 0;
+      coverage_bits = nullptr;
+      if (coverage_budget && *coverage_budget)
+	init_coverage_bits (obj_.get_coverage (), coverage_budget);
+    }
+    void fini () { hb_free (coverage_bits); }
+
+    bool may_have (hb_codepoint_t g) const
+    {
+      if (coverage_bits)
+      {
+	unsigned int i = g - coverage_start;
+	return i < coverage_words * 64
+	    && (coverage_bits[i / 64] & ((uint64_t) 1 << (i % 64)));
+      }
+      return digest.may_have (g);
     }
 
     bool apply (OT::hb_ot_apply_context_t *c) const
     {
-      return digest.may_have (c->buffer->cur().codepoint) && apply_func (obj, c);
+      return may_have (c->buffer->cur().codepoint) && apply_func (obj, c);
     }
 
     private:
+    /* Replaces the digest with an exact bitmap of the coverage,
+     * if it fits in what is left of the budget. */
+    void init_coverage_bits (const Coverage &coverage,
+			     unsigned int *coverage_budget)
+    {
+      hb_set_t glyphs;
+      coverage.collect_coverage (&glyphs);
+      if (unlikely (glyphs.in_error () || glyphs.is_empty ())) return;
+
+      hb_codepoint_t start = glyphs.get_min () & ~63u;
+      unsigned int words = (glyphs.get_max () - start) / 64 + 1;
+      if (words * sizeof (uint64_t) > *coverage_budget) return;
+
+      uint64_t *bits = (uint64_t *) hb_calloc (words, sizeof (uint64_t));
+      if (unlikely (!bits)) return;
+      for (hb_codepoint_t g : glyphs)
+	bits[(g - start) / 64] |= (uint64_t) 1 << ((g - start) % 64);
+
+      *coverage_budget -= words * sizeof (uint64_t);
+      coverage_start = start;
+      coverage_words = words;
+      coverage_bits = bits;
+    }
+
     const void *obj;
     hb_apply_func_t apply_func;
     hb_set_digest_t digest;
+    hb_codepoint_t coverage_start;
+    unsigned int coverage_words;
+    uint64_t *coverage_bits;	/* nullptr if using digest only. */
   };
 
   typedef hb_vector_t<hb_applicable_t> array_t;
@@ -826,15 +884,18 @@ struct hb_get_subtables_context_t :
   return_t dispatch (const T &obj)
   {
     hb_applicable_t *entry = array.push();
-    entry->init (obj, apply_to<T>);
+    entry->init (obj, apply_to<T>, coverage_budget);
     return hb_empty_t ();
   }
   static return_t default_return_value () { return hb_empty_t (); }
 
-  hb_get_subtables_context_t (array_t &array_) :
-			      array (array_) {}
+  hb_get_subtables_context_t (array_t &array_,
+			      unsigned int *coverage_budget_ = nullptr) :
+			      array (array_),
+			      coverage_budget (coverage_budget_) {}
 
   array_t &array;
+  unsigned int *coverage_budget;
 };
 
 
@@ -3609,20 +3670,29 @@ struct Extension
 
 struct hb_ot_layout_lookup_accelerator_t
 {
+  /* If coverage_budget is non-null, subtables use exact coverage bitmaps
+   * instead of digests while the budget (in bytes) lasts. */
   template <typename TLookup>
-  void init (const TLookup &lookup)
+  void init (const TLookup &lookup, unsigned int *coverage_budget = nullptr)
   {
     digest.init ();
     lookup.collect_coverage (&digest);
 
     subtables.init ();
-    OT::hb_get_subtables_context_t c_get_subtables (subtables);
+    OT::hb_get_subtables_context_t c_get_subtables (subtables, coverage_budget);
     lookup.dispatch (&c_get_subtables);
   }
-  void fini () { subtables.fini (); }
+  void fini ()
+  {
+    for (unsigned int i = 0; i < subtables.length; i++)
+      subtables[i].fini ();
+    subtables.fini ();
+  }
 
   bool may_have (hb_codepoint_t g) const
   { return digest.may_have (g); }
+  bool may_have (const hb_set_digest_t &glyphs) const
+  { return digest.may_have (glyphs); }
 
   bool apply (hb_ot_apply_context_t *c) const
   {
@@ -3937,8 +4007,9 @@ struct GSUBGPOS
 	this->table = hb_blob_get_empty ();
       }
 
+      unsigned int coverage_budget = face->lookup_accelerator_budget;
       for (unsigned int i = 0; i < this->lookup_count; i++)
-	this->accels[i].init (table->get_lookup (i));
+	this->accels[i].init (table->get_lookup (i), &coverage_budget);
     }
     ~accelerator_t ()
     {
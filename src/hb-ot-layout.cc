@@ -1835,15 +1835,24 @@ apply_forward (OT::hb_ot_apply_context_t *c,
   hb_buffer_t *buffer = c->buffer;
   while (buffer->idx < buffer->len && buffer->successful)
   {
-    bool applied = false;
-    if (accel.may_have (buffer->cur().codepoint) &&
-	(buffer->cur().mask & c->lookup_mask) &&
-	c->check_glyph_property (&buffer->cur(), c->lookup_props))
-     {
-       applied = accel.apply (c);
-     }
+    /* Most glyphs are rejected by the cheap checks alone.  Scan over the
+     * whole run of those first, then copy them to the output in one go,
+     * instead of going through next_glyph() for each. */
+    const hb_glyph_info_t *info = buffer->info;
+    unsigned int count = buffer->len;
+    unsigned int end = buffer->idx;
+    while (end < count &&
+	   !(accel.may_have (info[end].codepoint) &&
+	     (info[end].mask & c->lookup_mask) &&
+	     c->check_glyph_property (&info[end], c->lookup_props)))
+      end++;
+    if (end > buffer->idx)
+    {
+      (void) buffer->next_glyphs (end - buffer->idx);
+      continue;
+    }
 
-    if (applied)
+    if (accel.apply (c))
       ret = true;
     else
       (void) buffer->next_glyph ();
@@ -1916,6 +1925,7 @@ inline void hb_ot_map_t::apply (const Proxy &proxy,
   unsigned int i = 0;
   OT::hb_ot_apply_context_t c (table_index, font, buffer);
   c.set_recurse_func (Proxy::Lookup::apply_recurse_func);
+  c.digest = buffer->digest ();
 
   for (unsigned int stage_index = 0; stage_index < stages[table_index].length; stage_index++)
   {
@@ -1923,6 +1933,14 @@ inline void hb_ot_map_t::apply (const Proxy &proxy,
     for (; i < stage->last_lookup; i++)
     {
       unsigned int lookup_index = lookups[table_index][i].index;
+      const auto &accel = proxy.accels[lookup_index];
+
+      if (!accel.may_have (c.digest))
+      {
+	(void) buffer->message (font, "skipped lookup %d because no glyph matches", lookup_index);
+	continue;
+      }
+
       if (!buffer->message (font, "start lookup %d", lookup_index)) continue;
       c.set_lookup_index (lookup_index);
       c.set_lookup_mask (lookups[table_index][i].mask);
@@ -1932,12 +1950,16 @@ inline void hb_ot_map_t::apply (const Proxy &proxy,
 
       apply_string<Proxy> (&c,
 			   proxy.table.get_lookup (lookup_index),
-			   proxy.accels[lookup_index]);
+			   accel);
       (void) buffer->message (font, "end lookup %d", lookup_index);
     }
 
     if (stage->pause_func)
+    {
       stage->pause_func (plan, font, buffer);
+      /* Pause functions may insert or change glyphs. */
+      c.digest = buffer->digest ();
+    }
   }
 }
 
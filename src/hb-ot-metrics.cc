@@ -65,7 +65,7 @@ _hb_ot_metrics_get_position_common (hb_font_t           *font,
   switch ((unsigned) metrics_tag)
   {
 #ifndef HB_NO_VAR
-#define GET_VAR face->table.MVAR->get_var (metrics_tag, font->coords, font->num_coords)
+#define GET_VAR face->table.MVAR->get_var (metrics_tag, font)
 #else
 #define GET_VAR .0f
 #endif
@@ -109,7 +109,7 @@ _get_gasp (hb_face_t *face, float *result, hb_ot_metrics_tag_t metrics_tag)
 {
   const OT::GaspRange& range = face->table.gasp->get_gasp_range (metrics_tag - HB_TAG ('g','s','p','0'));
   if (&range == &Null (OT::GaspRange)) return false;
-  if (result) *result = range.rangeMaxPPEM + font->face->table.MVAR->get_var (metrics_tag, font->coords, font->num_coords);
+  if (result) *result = range.rangeMaxPPEM + font->face->table.MVAR->get_var (metrics_tag, font);
   return true;
 }
 #endif
@@ -393,7 +393,7 @@ hb_ot_metrics_get_position_with_fallback (hb_font_t           *font,
 float
 hb_ot_metrics_get_variation (hb_font_t *font, hb_ot_metrics_tag_t metrics_tag)
 {
-  return font->face->table.MVAR->get_var (metrics_tag, font->coords, font->num_coords);
+  return font->face->table.MVAR->get_var (metrics_tag, font);
 }
 
 /**
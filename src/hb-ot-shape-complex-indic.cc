@@ -347,10 +347,7 @@ setup_masks_indic (const hb_ot_shape_plan_t *plan HB_UNUSED,
   /* We cannot setup masks here.  We save information about characters
    * and setup masks later on in a pause-callback. */
 
-  unsigned int count = buffer->len;
-  hb_glyph_info_t *info = buffer->info;
-  for (unsigned int i = 0; i < count; i++)
-    set_indic_properties (info[i]);
+  hb_syllabic_set_properties<true> (buffer, set_indic_properties);
 }
 
 static void
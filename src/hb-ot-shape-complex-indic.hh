@@ -29,6 +29,7 @@
 
 #include "hb.hh"
 
+#include "hb-cache.hh"
 #include "hb-ot-shape-complex-syllabic.hh"
 
 
@@ -408,22 +409,44 @@ struct hb_indic_would_substitute_feature_t
     map->get_stage_lookups (0/*GSUB*/,
 			    map->get_feature_stage (0/*GSUB*/, feature_tag),
 			    &lookups, &count);
+    pair_cache.init ();
   }
 
   bool would_substitute (const hb_codepoint_t *glyphs,
 			 unsigned int          glyphs_count,
 			 hb_face_t            *face) const
   {
+    /* Glyph pairs, which are what syllables keep asking about, are
+     * memoized.  The key mixes the first glyph into the low bits that
+     * pick the cache slot, so a pair and its reverse do not collide. */
+    unsigned int key = 0;
+    bool cacheable = glyphs_count == 2 && glyphs[0] <= 0xFFFFu && glyphs[1] <= 0xFFFFu;
+    if (cacheable)
+    {
+      key = (glyphs[0] << 16) | ((glyphs[1] + glyphs[0] * 0x9E5u) & 0xFFFFu);
+      unsigned int v;
+      if (pair_cache.get (key, &v))
+	return v;
+    }
+
+    bool ret = false;
     for (unsigned int i = 0; i < count; i++)
       if (hb_ot_layout_lookup_would_substitute (face, lookups[i].index, glyphs, glyphs_count, zero_context))
-	return true;
-    return false;
+      {
+	ret = true;
+	break;
+      }
+
+    if (cacheable)
+      pair_cache.set (key, ret);
+    return ret;
   }
 
   private:
   const hb_ot_map_t::lookup_map_t *lookups;
   unsigned int count;
   bool zero_context;
+  mutable hb_cache_t<32, 1, 8> pair_cache;
 };
 
 
@@ -39,4 +39,50 @@ hb_syllabic_insert_dotted_circles (hb_font_t *font,
 				   int dottedcircle_position = -1);
 
 
+/* Fills in the syllabic category of every character in buffer, and its
+ * position too if with_position, using set_properties(), which may only
+ * look at the codepoint.  Running text keeps repeating a small set of
+ * characters, so results are remembered in a direct-mapped table keyed
+ * by the low bits of the codepoint, which covers a whole Indic block,
+ * and set_properties() only runs on a miss. */
+template <bool with_position, typename set_properties_t>
+static inline void
+hb_syllabic_set_properties (hb_buffer_t *buffer,
+			    const set_properties_t &set_properties)
+{
+  unsigned int count = buffer->len;
+  hb_glyph_info_t *info = buffer->info;
+
+  struct
+  {
+    hb_codepoint_t u;
+    uint8_t category;
+    uint8_t position;
+  } cache[128];
+  /* Seed every slot with a codepoint that belongs in another slot, so
+   * that no codepoint, not even (hb_codepoint_t) -1, ever matches an
+   * empty one and picks up its unset properties. */
+  for (unsigned int i = 0; i < ARRAY_LENGTH (cache); i++)
+    cache[i].u = i + 1;
+
+  for (unsigned int i = 0; i < count; i++)
+  {
+    hb_codepoint_t u = info[i].codepoint;
+    auto &entry = cache[u & (ARRAY_LENGTH (cache) - 1)];
+    if (entry.u == u)
+    {
+      info[i].complex_var_u8_category() = entry.category;
+      if (with_position)
+	info[i].complex_var_u8_auxiliary() = entry.position;
+      continue;
+    }
+
+    set_properties (info[i]);
+    entry.u = u;
+    entry.category = info[i].complex_var_u8_category();
+    entry.position = with_position ? info[i].complex_var_u8_auxiliary() : 0;
+  }
+}
+
+
 #endif /* HB_OT_SHAPE_COMPLEX_SYLLABIC_HH */
@@ -203,10 +203,9 @@ setup_masks_use (const hb_ot_shape_plan_t *plan,
   /* We cannot setup masks here.  We save information about characters
    * and setup masks later on in a pause-callback. */
 
-  unsigned int count = buffer->len;
-  hb_glyph_info_t *info = buffer->info;
-  for (unsigned int i = 0; i < count; i++)
-    info[i].use_category() = hb_use_get_category (info[i].codepoint);
+  hb_syllabic_set_properties<false> (buffer,
+				     [] (hb_glyph_info_t &info)
+				     { info.use_category() = hb_use_get_category (info.codepoint); });
 }
 
 static void
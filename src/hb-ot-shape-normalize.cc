@@ -171,6 +171,10 @@ decompose_current_character (const hb_ot_shape_normalize_context_t *c, bool shor
   hb_codepoint_t u = buffer->cur().codepoint;
   hb_codepoint_t glyph = 0;
 
+  /* Characters that won't decompose come out the same either way. */
+  if (!shortest && c->quick_check && !_hb_ucd_has_decomposition (u))
+    shortest = true;
+
   if (shortest && c->font->get_nominal_glyph (u, &glyph, c->not_found))
   {
     next_char (buffer, glyph);
@@ -315,7 +319,8 @@ _hb_ot_shape_normalize (const hb_ot_shape_plan_t *plan,
     buffer->unicode,
     buffer->not_found,
     plan->shaper->decompose ? plan->shaper->decompose : decompose_unicode,
-    plan->shaper->compose   ? plan->shaper->compose   : compose_unicode
+    plan->shaper->compose   ? plan->shaper->compose   : compose_unicode,
+    buffer->unicode == hb_ucd_get_unicode_funcs () && !plan->shaper->decompose
   };
 
   bool always_short_circuit = mode == HB_OT_SHAPE_NORMALIZATION_MODE_NONE;
@@ -348,10 +353,18 @@ _hb_ot_shape_normalize (const hb_ot_shape_plan_t *plan,
       if (end < count)
 	end--; /* Leave one base for the marks to cluster with. */
 
-      /* From idx to end are simple clusters. */
+      /* From idx to end are simple clusters.  When not short-circuiting,
+       * we can still map the leading ones that don't decompose directly. */
+      unsigned int stable_end = buffer->idx;
       if (might_short_circuit)
+	stable_end = end;
+      else if (c.quick_check)
+	while (stable_end < end &&
+	       !_hb_ucd_has_decomposition (buffer->info[stable_end].codepoint))
+	  stable_end++;
+      if (stable_end > buffer->idx)
       {
-	unsigned int done = font->get_nominal_glyphs (end - buffer->idx,
+	unsigned int done = font->get_nominal_glyphs (stable_end - buffer->idx,
 						      &buffer->cur().codepoint,
 						      sizeof (buffer->info[0]),
 						      &buffer->cur().glyph_index(),
@@ -65,6 +65,9 @@ struct hb_ot_shape_normalize_context_t
 		   hb_codepoint_t  a,
 		   hb_codepoint_t  b,
 		   hb_codepoint_t *ab);
+  /* Whether decompose() is known to fail for characters without a
+   * decomposition in our UCD data; see _hb_ucd_has_decomposition(). */
+  bool quick_check;
 };
 
 
@@ -53,6 +53,9 @@ struct hb_ot_shape_plan_key_t
   {
     return 0 == memcmp (this, other, sizeof (*this));
   }
+
+  uint32_t hash () const
+  { return variations_index[0] * 31u + variations_index[1]; }
 };
 
 
@@ -29,6 +29,7 @@
 #define HB_OT_VAR_GVAR_TABLE_HH
 
 #include "hb-open-type.hh"
+#include "hb-pool.hh"
 
 /*
  * gvar -- Glyph Variation Table
@@ -500,7 +501,11 @@ struct gvar
   {
     accelerator_t (hb_face_t *face)
     { table = hb_sanitize_context_t ().reference_table<gvar> (face); }
-    ~accelerator_t () { table.destroy (); }
+    ~accelerator_t ()
+    {
+      scratch_pool.fini ();
+      table.destroy ();
+    }
 
     private:
     struct x_getter { static float get (const contour_point_t &p) { return p.x; } };
@@ -543,29 +548,80 @@ struct gvar
 
       hb_bytes_t var_data_bytes = table->get_glyph_var_data_bytes (table.get_blob (), glyph);
       if (!var_data_bytes.as<GlyphVariationData> ()->has_data ()) return true;
+
+      scratch_t *scratch = scratch_pool.acquire ();
+      if (unlikely (!scratch)) return false;
+      bool ret = apply_deltas_to_points (font, points, var_data_bytes, *scratch);
+      scratch_pool.release (scratch);
+      return ret;
+    }
+
+    protected:
+    /* Buffers reused across apply_deltas_to_points() calls, so that
+     * applying variations doesn't allocate once warmed up. */
+    struct scratch_t
+    {
+      /* Don't hold on to what one huge glyph needed for the lifetime
+       * of the face. */
+      void trim ()
+      {
+	trim (shared_indices);
+	trim (private_indices);
+	trim (x_deltas);
+	trim (y_deltas);
+	trim (orig_points);
+	trim (deltas);
+	trim (end_points);
+      }
+      template <typename Type>
+      static void trim (hb_vector_t<Type> &v)
+      { if (v.get_allocated () > max_kept_points) v.fini (); }
+      static constexpr unsigned max_kept_points = 4096;
+
       hb_vector_t<unsigned int> shared_indices;
+      hb_vector_t<unsigned int> private_indices;
+      hb_vector_t<int> x_deltas;
+      hb_vector_t<int> y_deltas;
+      contour_point_vector_t orig_points;
+      contour_point_vector_t deltas; /* flag is used to indicate referenced point */
+      hb_vector_t<unsigned> end_points;
+    };
+
+    bool apply_deltas_to_points (hb_font_t *font,
+				 const hb_array_t<contour_point_t> points,
+				 hb_bytes_t var_data_bytes,
+				 scratch_t &scratch) const
+    {
+      hb_vector_t<unsigned int> &shared_indices = scratch.shared_indices;
+      shared_indices.resize (0);
       GlyphVariationData::tuple_iterator_t iterator;
       if (!GlyphVariationData::get_tuple_iterator (var_data_bytes, table->axisCount,
 						   shared_indices, &iterator))
 	return true; /* so isn't applied at all */
 
       /* Save original points for inferred delta calculation */
-      contour_point_vector_t orig_points;
-      orig_points.resize (points.length);
-      for (unsigned int i = 0; i < orig_points.length; i++)
-	orig_points[i] = points[i];
+      contour_point_vector_t &orig_points = scratch.orig_points;
+      orig_points.resize (0);
+      orig_points.extend (points);
 
-      contour_point_vector_t deltas; /* flag is used to indicate referenced point */
+      contour_point_vector_t &deltas = scratch.deltas;
       deltas.resize (points.length);
 
-      hb_vector_t<unsigned> end_points;
+      hb_vector_t<unsigned> &end_points = scratch.end_points;
+      end_points.resize (0);
       for (unsigned i = 0; i < points.length; ++i)
 	if (points[i].is_end_point)
 	  end_points.push (i);
 
+      if (unlikely (orig_points.in_error () || deltas.in_error () || end_points.in_error ()))
+	return false;
+
       int *coords = font->coords;
       unsigned num_coords = font->num_coords;
       hb_array_t<const F2DOT14> shared_tuples = (table+table->sharedTuples).as_array (table->sharedTupleCount * table->axisCount);
+      hb_vector_t<unsigned int> &private_indices = scratch.private_indices;
+      hb_vector_t<int> &x_deltas = scratch.x_deltas;
+      hb_vector_t<int> &y_deltas = scratch.y_deltas;
       do
       {
 	float scalar = iterator.current_tuple->calculate_scalar (coords, num_coords, shared_tuples);
@@ -576,33 +632,55 @@ struct gvar
 	  return false;
 
 	hb_bytes_t bytes ((const char *) p, length);
-	hb_vector_t<unsigned int> private_indices;
-	if (iterator.current_tuple->has_private_points () &&
+	bool has_private_points = iterator.current_tuple->has_private_points ();
+	if (has_private_points &&
 	    !GlyphVariationData::unpack_points (p, private_indices, bytes))
 	  return false;
-	const hb_array_t<unsigned int> &indices = private_indices.length ? private_indices : shared_indices;
+	const hb_array_t<unsigned int> &indices = has_private_points && private_indices.length ? private_indices : shared_indices;
 
 	bool apply_to_all = (indices.length == 0);
 	unsigned int num_deltas = apply_to_all ? points.length : indices.length;
-	hb_vector_t<int> x_deltas;
-	x_deltas.resize (num_deltas);
+	if (unlikely (!x_deltas.resize (num_deltas) ||
+		      !y_deltas.resize (num_deltas)))
+	  return false;
 	if (!GlyphVariationData::unpack_deltas (p, x_deltas, bytes))
 	  return false;
-	hb_vector_t<int> y_deltas;
-	y_deltas.resize (num_deltas);
 	if (!GlyphVariationData::unpack_deltas (p, y_deltas, bytes))
 	  return false;
 
+	if (apply_to_all)
+	{
+	  /* Every point has an explicit delta, so there is nothing to infer.
+	   * The scaled deltas still go through memory before being added,
+	   * like below: a plain `x += d * scalar' may be contracted into an
+	   * FMA, which rounds differently, and GCC contracts across
+	   * temporaries too. */
+	  contour_point_t *pts = points.arrayZ;
+	  contour_point_t *ds = deltas.arrayZ;
+	  const int *xs = x_deltas.arrayZ;
+	  const int *ys = y_deltas.arrayZ;
+	  for (unsigned int i = 0; i < num_deltas; i++)
+	  {
+	    ds[i].x = xs[i] * scalar;
+	    ds[i].y = ys[i] * scalar;
+	  }
+	  for (unsigned int i = 0; i < num_deltas; i++)
+	  {
+	    pts[i].x += ds[i].x;
+	    pts[i].y += ds[i].y;
+	  }
+	  continue;
+	}
+
 	for (unsigned int i = 0; i < deltas.length; i++)
-	  deltas[i].init ();
+	  deltas.arrayZ[i].init ();
 	for (unsigned int i = 0; i < num_deltas; i++)
 	{
-	  unsigned int pt_index = apply_to_all ? i : indices[i];
+	  unsigned int pt_index = indices.arrayZ[i];
 	  deltas[pt_index].flag = 1;	/* this point is referenced, i.e., explicit deltas specified */
-	  deltas[pt_index].x += x_deltas[i] * scalar;
-	  deltas[pt_index].y += y_deltas[i] * scalar;
+	  deltas[pt_index].x += x_deltas.arrayZ[i] * scalar;
+	  deltas[pt_index].y += y_deltas.arrayZ[i] * scalar;
 	}
-
 	/* infer deltas for unreferenced points */
 	unsigned start_point = 0;
 	for (unsigned c = 0; c < end_points.length; c++)
@@ -656,18 +734,20 @@ no_more_gaps:
 	/* apply specified / inferred deltas to points */
 	for (unsigned int i = 0; i < points.length; i++)
 	{
-	  points[i].x += deltas[i].x;
-	  points[i].y += deltas[i].y;
+	  points.arrayZ[i].x += deltas.arrayZ[i].x;
+	  points.arrayZ[i].y += deltas.arrayZ[i].y;
 	}
       } while (iterator.move_to_next ());
 
       return true;
     }
 
+    public:
     unsigned int get_axis_count () const { return table->axisCount; }
 
     private:
     hb_blob_ptr_t<gvar> table;
+    hb_single_pool_t<scratch_t> scratch_pool;
   };
 
   protected:
@@ -322,7 +322,7 @@ struct HVARVVAR
   float get_advance_var (hb_codepoint_t glyph, hb_font_t *font) const
   {
     uint32_t varidx = (this+advMap).map (glyph);
-    return (this+varStore).get_delta (varidx, font->coords, font->num_coords);
+    return (this+varStore).get_delta (varidx, font);
   }
 
   float get_side_bearing_var (hb_codepoint_t glyph,
@@ -97,4 +97,51 @@ struct hb_pool_t
 };
 
 
+/* Keeps a single object around for reuse, so that hot functions
+ * needing scratch space don't allocate once warmed up.  A caller
+ * finding it taken, by another thread, or by a reentrant call, gets
+ * a fresh one for the duration of its call.  T::trim() is called on
+ * release, to drop storage not worth keeping around. */
+template <typename T>
+struct hb_single_pool_t
+{
+  hb_single_pool_t () : slot (nullptr) {}
+  ~hb_single_pool_t () { fini (); }
+
+  void fini ()
+  {
+    destroy (slot.get_relaxed ());
+    slot.set_relaxed (nullptr);
+  }
+
+  T *acquire () const
+  {
+    T *obj = slot.get ();
+    if (obj && slot.cmpexch (obj, nullptr))
+      return obj;
+
+    obj = (T *) hb_calloc (1, sizeof (T));
+    if (unlikely (!obj)) return nullptr;
+    return new (obj) T ();
+  }
+
+  void release (T *obj) const
+  {
+    obj->trim ();
+    if (!slot.cmpexch (nullptr, obj))
+      destroy (obj);
+  }
+
+  private:
+  static void destroy (T *obj)
+  {
+    if (!obj) return;
+    obj->~T ();
+    hb_free (obj);
+  }
+
+  mutable hb_atomic_ptr_t<T> slot;
+};
+
+
 #endif /* HB_POOL_HH */
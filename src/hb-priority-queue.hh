@@ -33,8 +33,12 @@
 /*
  * hb_priority_queue_t
  *
- * Priority queue implemented as a binary heap. Supports extract minimum
- * and insert operations.
+ * Priority queue implemented as a 4-ary heap. Supports extract minimum,
+ * insert, and decrease priority operations.
+ *
+ * Values are unsigned integers which index a position table, so each value
+ * may be queued at most once at a time and values should be reasonably
+ * dense (eg. object indices).
  */
 struct hb_priority_queue_t
 {
@@ -45,29 +49,61 @@ struct hb_priority_queue_t
  private:
   typedef hb_pair_t<int64_t, unsigned> item_t;
   hb_vector_t<item_t> heap;
+  /* Heap index + 1 of each queued value; 0 if not queued. */
+  hb_vector_t<unsigned> positions;
 
  public:
-  void init () { heap.init (); }
+  void init () { heap.init (); positions.init (); }
+
+  void fini () { heap.fini (); positions.fini (); }
 
-  void fini () { heap.fini (); }
+  void reset () { heap.resize (0); positions.resize (0); }
 
-  void reset () { heap.resize (0); }
+  bool in_error () const { return heap.in_error () || positions.in_error (); }
 
-  bool in_error () const { return heap.in_error (); }
+  bool alloc (unsigned size)
+  { return heap.alloc (size) && positions.alloc (size); }
 
   void insert (int64_t priority, unsigned value)
   {
+    if (unlikely (!track (value))) return;
     heap.push (item_t (priority, value));
+    if (unlikely (heap.in_error ())) return;
     bubble_up (heap.length - 1);
   }
 
+  /* Lowers the priority of value if it is queued with a higher one,
+   * otherwise inserts it if it is not queued at all. */
+  void insert_or_decrease (int64_t priority, unsigned value)
+  {
+    if (!contains (value))
+    {
+      insert (priority, value);
+      return;
+    }
+
+    unsigned index = positions.arrayZ[value] - 1;
+    if (heap.arrayZ[index].first <= priority)
+      return;
+
+    heap.arrayZ[index].first = priority;
+    bubble_up (index);
+  }
+
+  bool contains (unsigned value) const
+  { return value < positions.length && positions.arrayZ[value]; }
+
   item_t pop_minimum ()
   {
-    item_t result = heap[0];
+    if (unlikely (!heap.length)) return item_t (0, 0);
 
-    heap[0] = heap[heap.length - 1];
+    item_t result = heap.arrayZ[0];
+    positions.arrayZ[result.second] = 0;
+
+    heap.arrayZ[0] = heap.arrayZ[heap.length - 1];
     heap.shrink (heap.length - 1);
-    bubble_down (0);
+    if (heap.length)
+      bubble_down (0);
 
     return result;
   }
@@ -87,64 +123,66 @@ struct hb_priority_queue_t
 
  private:
 
+  /* A wider heap is shallower, which makes insertions and priority
+   * decreases cheaper; the children of a node share a cache line. */
+  static constexpr unsigned arity = 4;
+
   static constexpr unsigned parent (unsigned index)
   {
-    return (index - 1) / 2;
+    return (index - 1) / arity;
+  }
+
+  static constexpr unsigned first_child (unsigned index)
+  {
+    return arity * index + 1;
   }
 
-  static constexpr unsigned left_child (unsigned index)
+  bool track (unsigned value)
   {
-    return 2 * index + 1;
+    if (likely (value < positions.length)) return true;
+    return positions.resize (value + 1);
   }
 
-  static constexpr unsigned right_child (unsigned index)
+  void set (unsigned index, const item_t &item)
   {
-    return 2 * index + 2;
+    heap.arrayZ[index] = item;
+    positions.arrayZ[item.second] = index + 1;
   }
 
   void bubble_down (unsigned index)
   {
-    unsigned left = left_child (index);
-    unsigned right = right_child (index);
+    item_t item = heap.arrayZ[index];
+    while (true)
+    {
+      unsigned first = first_child (index);
+      if (first >= heap.length) break;
 
-    bool has_left = left < heap.length;
-    if (!has_left)
-      // If there's no left, then there's also no right.
-      return;
+      unsigned last = hb_min (first + arity, heap.length);
+      unsigned min_child = first;
+      for (unsigned i = first + 1; i < last; i++)
+        if (heap.arrayZ[i].first < heap.arrayZ[min_child].first)
+          min_child = i;
 
-    bool has_right = right < heap.length;
-    if (heap[index].first <= heap[left].first
-        && (!has_right || heap[index].first <= heap[right].first))
-      return;
+      if (item.first <= heap.arrayZ[min_child].first) break;
 
-    if (!has_right || heap[left].first < heap[right].first)
-    {
-      swap (index, left);
-      bubble_down (left);
-      return;
+      set (index, heap.arrayZ[min_child]);
+      index = min_child;
     }
-
-    swap (index, right);
-    bubble_down (right);
+    set (index, item);
   }
 
   void bubble_up (unsigned index)
   {
-    if (index == 0) return;
-
-    unsigned parent_index = parent (index);
-    if (heap[parent_index].first <= heap[index].first)
-      return;
-
-    swap (index, parent_index);
-    bubble_up (parent_index);
-  }
+    item_t item = heap.arrayZ[index];
+    while (index)
+    {
+      unsigned parent_index = parent (index);
+      if (heap.arrayZ[parent_index].first <= item.first) break;
 
-  void swap (unsigned a, unsigned b)
-  {
-    item_t temp = heap[a];
-    heap[a] = heap[b];
-    heap[b] = temp;
+      set (index, heap.arrayZ[parent_index]);
+      index = parent_index;
+    }
+    set (index, item);
   }
 };
 
@@ -277,8 +277,9 @@ struct graph_t
       unsigned next_id = queue[0];
       queue.remove (0);
 
-      vertex_t& next = vertices_[next_id];
-      sorted_graph[new_id] = next;
+      // Move rather than copy, the old graph is discarded after sorting.
+      hb_swap (sorted_graph[new_id], vertices_[next_id]);
+      const vertex_t& next = sorted_graph[new_id];
       id_map[next_id] = new_id--;
 
       for (const auto& link : next.obj.all_links ()) {
@@ -315,6 +316,7 @@ struct graph_t
     update_distances ();
 
     hb_priority_queue_t queue;
+    if (unlikely (!check_success (queue.alloc (vertices_.length)))) return;
     hb_vector_t<vertex_t> sorted_graph;
     if (unlikely (!check_success (sorted_graph.resize (vertices_.length)))) return;
     hb_vector_t<unsigned> id_map;
@@ -331,8 +333,9 @@ struct graph_t
     {
       unsigned next_id = queue.pop_minimum().second;
 
-      vertex_t& next = vertices_[next_id];
-      sorted_graph[new_id] = next;
+      // Move rather than copy, the old graph is discarded after sorting.
+      hb_swap (sorted_graph[new_id], vertices_[next_id]);
+      const vertex_t& next = sorted_graph[new_id];
       id_map[next_id] = new_id--;
 
       for (const auto& link : next.obj.all_links ()) {
@@ -568,9 +571,8 @@ struct graph_t
     // The last object is the root of the graph, so swap back the root to the end.
     // The root's obj idx does change, however since it's root nothing else refers to it.
     // all other obj idx's will be unaffected.
-    vertex_t root = vertices_[vertices_.length - 2];
-    vertices_[clone_idx] = *clone;
-    vertices_[vertices_.length - 1] = root;
+    hb_swap (vertices_[clone_idx], *clone);
+    const vertex_t& root = vertices_[root_idx ()];
 
     // Since the root moved, update the parents arrays of all children on the root.
     for (const auto& l : root.obj.all_links ())
@@ -606,6 +608,7 @@ struct graph_t
     DEBUG_MSG (SUBSET_REPACK, nullptr, "  Duplicating %d => %d",
                parent_idx, child_idx);
 
+    bool had_distances = !distance_invalid;
     unsigned clone_idx = duplicate (child_idx);
     if (clone_idx == (unsigned) -1) return false;
     // duplicate shifts the root node idx, so if parent_idx was root update it.
@@ -620,6 +623,12 @@ struct graph_t
       reassign_link (l, parent_idx, clone_idx);
     }
 
+    if (had_distances)
+    {
+      distance_invalid = false;
+      update_distances_for_duplicate (child_idx, clone_idx);
+    }
+
     return true;
   }
 
@@ -853,12 +862,10 @@ struct graph_t
     // https://en.wikipedia.org/wiki/Dijkstra%27s_algorithm
     //
     // Implementation Note:
-    // Since our priority queue doesn't support fast priority decreases
-    // we instead just add new entries into the queue when a priority changes.
-    // Redundant ones are filtered out later on by the visited set.
-    // According to https://www3.cs.stonybrook.edu/~rezaul/papers/TR-07-54.pdf
-    // for practical performance this is faster then using a more advanced queue
-    // (such as a fibonacci queue) with a fast decrease priority.
+    // The queue lowers the priority of an already queued object in place
+    // instead of queuing it a second time, so it never holds more than one
+    // entry per object and no visited set is needed: weights are positive,
+    // so an object's distance can't improve once it has been popped.
     for (unsigned i = 0; i < vertices_.length; i++)
     {
       if (i == vertices_.length - 1)
@@ -868,33 +875,23 @@ struct graph_t
     }
 
     hb_priority_queue_t queue;
+    if (unlikely (!check_success (queue.alloc (vertices_.length)))) return;
     queue.insert (0, vertices_.length - 1);
 
-    hb_vector_t<bool> visited;
-    visited.resize (vertices_.length);
-
     while (!queue.in_error () && !queue.is_empty ())
     {
       unsigned next_idx = queue.pop_minimum ().second;
-      if (visited[next_idx]) continue;
       const auto& next = vertices_[next_idx];
       int64_t next_distance = vertices_[next_idx].distance;
-      visited[next_idx] = true;
 
       for (const auto& link : next.obj.all_links ())
       {
-        if (visited[link.objidx]) continue;
-
-        const auto& child = vertices_[link.objidx].obj;
-        unsigned link_width = link.width ? link.width : 4; // treat virtual offsets as 32 bits wide
-        int64_t child_weight = (child.tail - child.head) +
-                               ((int64_t) 1 << (link_width * 8)) * (vertices_[link.objidx].space + 1);
-        int64_t child_distance = next_distance + child_weight;
+        int64_t child_distance = next_distance + link_weight (link);
 
         if (child_distance < vertices_[link.objidx].distance)
         {
           vertices_[link.objidx].distance = child_distance;
-          queue.insert (child_distance, link.objidx);
+          queue.insert_or_decrease (child_distance, link.objidx);
         }
       }
     }
@@ -909,6 +906,53 @@ struct graph_t
     distance_invalid = false;
   }
 
+  /*
+   * Updates distances in place after the links from a parent to child_idx
+   * have been moved over to its new duplicate clone_idx.
+   *
+   * The clone is only linked from that parent, which can't be reached from
+   * child_idx so it keeps its distance. The children of the clone are
+   * also children of child_idx, whose distance can only grow, so they keep
+   * theirs unless it does. In that case fall back to a full recompute.
+   */
+  void update_distances_for_duplicate (unsigned child_idx, unsigned clone_idx)
+  {
+    if (distance_from_parents (child_idx) != vertices_[child_idx].distance)
+    {
+      distance_invalid = true;
+      return;
+    }
+
+    vertices_[clone_idx].distance = distance_from_parents (clone_idx);
+  }
+
+  /*
+   * Shortest distance to node_idx through its parents, assuming
+   * their distances are up to date.
+   */
+  int64_t distance_from_parents (unsigned node_idx) const
+  {
+    int64_t distance = hb_int_max (int64_t);
+    for (unsigned p : vertices_[node_idx].parents)
+    {
+      int64_t parent_distance = vertices_[p].distance;
+      if (parent_distance == hb_int_max (int64_t)) continue;
+
+      for (const auto& link : vertices_[p].obj.all_links ())
+        if (link.objidx == node_idx)
+          distance = hb_min (distance, parent_distance + link_weight (link));
+    }
+    return distance;
+  }
+
+  int64_t link_weight (const hb_serialize_context_t::object_t::link_t& link) const
+  {
+    const auto& child = vertices_[link.objidx];
+    unsigned link_width = link.width ? link.width : 4; // treat virtual offsets as 32 bits wide
+    return (child.obj.tail - child.obj.head) +
+           ((int64_t) 1 << (link_width * 8)) * (child.space + 1);
+  }
+
   int64_t compute_offset (
       unsigned parent_idx,
       const hb_serialize_context_t::object_t::link_t& link) const
@@ -101,6 +101,9 @@ struct hb_set_digest_lowest_bits_t
   template <typename T>
   bool add_sorted_array (const hb_sorted_array_t<const T>& arr) { return add_sorted_array (&arr, arr.len ()); }
 
+  bool may_have (const hb_set_digest_lowest_bits_t &o) const
+  { return !!(mask & o.mask); }
+
   bool may_have (hb_codepoint_t g) const
   { return !!(mask & mask_for (g)); }
 
@@ -150,6 +153,12 @@ struct hb_set_digest_combiner_t
   template <typename T>
   bool add_sorted_array (const hb_sorted_array_t<const T>& arr) { return add_sorted_array (&arr, arr.len ()); }
 
+  /* Whether the two sets may intersect. */
+  bool may_have (const hb_set_digest_combiner_t &o) const
+  {
+    return head.may_have (o.head) && tail.may_have (o.tail);
+  }
+
   bool may_have (hb_codepoint_t g) const
   {
     return head.may_have (g) && tail.may_have (g);
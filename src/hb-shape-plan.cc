@@ -163,6 +163,291 @@ hb_shape_plan_key_t::equal (const hb_shape_plan_key_t *other)
 	 this->shaper_func == other->shaper_func;
 }
 
+uint32_t
+hb_shape_plan_key_t::hash () const
+{
+  uint32_t h = hb_segment_properties_hash (&this->props);
+  for (unsigned int i = 0; i < num_user_features; i++)
+  {
+    const hb_feature_t &feature = user_features[i];
+    bool global = feature.start == HB_FEATURE_GLOBAL_START &&
+		  feature.end   == HB_FEATURE_GLOBAL_END;
+    h = h * 31u + (feature.tag ^ (feature.value * 2654435761u) ^ global);
+  }
+#ifndef HB_NO_OT_SHAPE
+  h = h * 31u + this->ot.hash ();
+#endif
+  h = h * 31u + (uint32_t) (uintptr_t) this->shaper_func;
+
+  /* Final mix; buckets are indexed by the low bits. */
+  h ^= h >> 16;
+  h *= 0x45d9f3bu;
+  h ^= h >> 16;
+  return h;
+}
+
+
+/*
+ * hb_shape_plan_cache_t
+ */
+
+void
+hb_shape_plan_cache_t::fini ()
+{
+  for (node_t *node : nodes)
+  {
+    hb_shape_plan_destroy (node->shape_plan);
+    hb_free (node);
+  }
+  nodes.fini ();
+  hb_free (buckets.get_relaxed ());
+  buckets.init ();
+
+  for (void *p : garbage)
+    hb_free (p);
+  garbage.fini ();
+  for (hb_shape_plan_t *shape_plan : garbage_plans)
+    hb_shape_plan_destroy (shape_plan);
+  garbage_plans.fini ();
+
+  lock.fini ();
+}
+
+hb_shape_plan_cache_t::node_t *
+hb_shape_plan_cache_t::find (const hb_shape_plan_key_t *key, uint32_t hash)
+{
+  buckets_t *b = buckets.get ();
+  if (unlikely (!b))
+    return nullptr;
+
+  for (node_t *node = b->arrayZ[hash & (b->length - 1)].get (); node; node = node->next.get ())
+    if (node->hash == hash && node->shape_plan->key.equal (key))
+      return node;
+  return nullptr;
+}
+
+/* Unlinks nodes[i] and retires it, along with its plan. */
+bool
+hb_shape_plan_cache_t::remove (unsigned int i)
+{
+  if (unlikely (!garbage.alloc (garbage.length + 1) ||
+		!garbage_plans.alloc (garbage_plans.length + 1)))
+    return false;
+
+  node_t *node = nodes[i];
+  buckets_t *b = buckets.get_relaxed ();
+  hb_atomic_ptr_t<node_t> *p = &b->arrayZ[node->hash & (b->length - 1)];
+  while (p->get_relaxed () != node)
+    p = &p->get_relaxed ()->next;
+  /* Lookups still on node carry on to the rest of the chain. */
+  p->set (node->next.get_relaxed ());
+
+  nodes.remove (i);
+  garbage.push (node);
+  garbage_plans.push (node->shape_plan);
+  return true;
+}
+
+void
+hb_shape_plan_cache_t::shrink (unsigned int max)
+{
+  while (nodes.length > max)
+  {
+    if (hand >= nodes.length)
+      hand = 0;
+
+    /* Give recently used plans a second chance. */
+    hb_shape_plan_t *shape_plan = nodes[hand]->shape_plan;
+    if (shape_plan->cache_referenced.get_relaxed ())
+    {
+      shape_plan->cache_referenced.set_relaxed (0);
+      hand++;
+      continue;
+    }
+
+    if (unlikely (!remove (hand)))
+      return;
+    evictions++;
+  }
+}
+
+/* Rehashes into new_length buckets.  Lookups may be walking the old
+ * chains, so those are left alone: the nodes are copied over and the
+ * old ones retired. */
+bool
+hb_shape_plan_cache_t::rebuild (unsigned int new_length)
+{
+  if (unlikely (!garbage.alloc (garbage.length + nodes.length + 1)))
+    return false;
+
+  buckets_t *new_buckets = (buckets_t *) hb_calloc (1, sizeof (buckets_t) +
+							(new_length - HB_VAR_ARRAY) * sizeof (new_buckets->arrayZ[0]));
+  if (unlikely (!new_buckets))
+    return false;
+  new_buckets->length = new_length;
+
+  hb_vector_t<node_t *> new_nodes;
+  if (unlikely (!new_nodes.alloc (nodes.length)))
+  {
+    hb_free (new_buckets);
+    return false;
+  }
+  for (node_t *node : nodes)
+  {
+    node_t *new_node = (node_t *) hb_calloc (1, sizeof (node_t));
+    if (unlikely (!new_node))
+    {
+      for (node_t *n : new_nodes)
+	hb_free (n);
+      hb_free (new_buckets);
+      return false;
+    }
+    new_node->shape_plan = node->shape_plan;
+    new_node->hash = node->hash;
+    hb_atomic_ptr_t<node_t> &bucket = new_buckets->arrayZ[node->hash & (new_length - 1)];
+    new_node->next.set_relaxed (bucket.get_relaxed ());
+    bucket.set_relaxed (new_node);
+    new_nodes.push (new_node);
+  }
+
+  buckets_t *old_buckets = buckets.get_relaxed ();
+  buckets.set (new_buckets);
+
+  if (old_buckets)
+    garbage.push (old_buckets);
+  for (node_t *node : nodes)
+    garbage.push (node);
+  hb_swap (nodes, new_nodes);
+  return true;
+}
+
+void
+hb_shape_plan_cache_t::collect_garbage ()
+{
+  if (!garbage.length && !garbage_plans.length)
+    return;
+
+  /* Anything in the garbage is already unreachable for lookups that
+   * start from now on.  Any lookup that started earlier is still in
+   * flight if it entered but did not leave yet.  Read leaves first:
+   * if lookups is no larger, none was in flight when we read leaves. */
+  _hb_memory_barrier ();
+  int left = leaves.get ();
+  if (lookups.get () != left)
+    return; /* Try again next time. */
+
+  for (void *p : garbage)
+    hb_free (p);
+  garbage.resize (0);
+  for (hb_shape_plan_t *shape_plan : garbage_plans)
+    hb_shape_plan_destroy (shape_plan);
+  garbage_plans.resize (0);
+}
+
+hb_shape_plan_t *
+hb_shape_plan_cache_t::lookup (const hb_shape_plan_key_t *key, uint32_t hash)
+{
+  lookups.inc ();
+
+  hb_shape_plan_t *shape_plan = nullptr;
+  node_t *node = find (key, hash);
+  if (node)
+  {
+    /* Only write if needed, to keep the cacheline shared. */
+    if (!node->shape_plan->cache_referenced.get_relaxed ())
+      node->shape_plan->cache_referenced.set_relaxed (1);
+    shape_plan = hb_shape_plan_reference (node->shape_plan);
+  }
+  else
+    misses.inc ();
+
+  leaves.inc ();
+  return shape_plan;
+}
+
+hb_shape_plan_t *
+hb_shape_plan_cache_t::insert (hb_shape_plan_t *shape_plan, uint32_t hash,
+			       bool *inserted)
+{
+  hb_lock_t l (lock);
+  *inserted = false;
+
+  /* Another thread might have beaten us to it. */
+  node_t *node = find (&shape_plan->key, hash);
+  if (node)
+  {
+    hb_shape_plan_destroy (shape_plan);
+    return hb_shape_plan_reference (node->shape_plan);
+  }
+
+  if (!max_plans)
+    return shape_plan;
+
+  buckets_t *b = buckets.get_relaxed ();
+  if (!b || nodes.length >= b->length)
+  {
+    if (!rebuild (b ? b->length * 2 : 8) && !b)
+      return shape_plan;
+    b = buckets.get_relaxed ();
+  }
+
+  if (unlikely (!nodes.alloc (nodes.length + 1)))
+    return shape_plan;
+  node = (node_t *) hb_calloc (1, sizeof (node_t));
+  if (unlikely (!node))
+    return shape_plan;
+
+  node->shape_plan = shape_plan;
+  node->hash = hash;
+  /* Don't let the sweep below take it right away. */
+  shape_plan->cache_referenced.set_relaxed (1);
+  hb_atomic_ptr_t<node_t> &bucket = b->arrayZ[hash & (b->length - 1)];
+  node->next.set_relaxed (bucket.get_relaxed ());
+  bucket.set (node);
+  nodes.push (node);
+  *inserted = true;
+
+  /* Take the reference we return before possibly evicting. */
+  hb_shape_plan_reference (shape_plan);
+  shrink (max_plans);
+  collect_garbage ();
+
+  return shape_plan;
+}
+
+void
+hb_shape_plan_cache_t::set_max_plans (unsigned int max_plans_)
+{
+  hb_lock_t l (lock);
+
+  max_plans = max_plans_;
+  shrink (max_plans);
+  collect_garbage ();
+}
+
+static hb_shape_plan_cache_t *
+_hb_face_get_shape_plan_cache (hb_face_t *face)
+{
+retry:
+  hb_shape_plan_cache_t *cache = face->shape_plans;
+  if (likely (cache))
+    return cache;
+
+  cache = (hb_shape_plan_cache_t *) hb_calloc (1, sizeof (hb_shape_plan_cache_t));
+  if (unlikely (!cache))
+    return nullptr;
+  cache->init ();
+
+  if (unlikely (!face->shape_plans.cmpexch (nullptr, cache)))
+  {
+    cache->fini ();
+    hb_free (cache);
+    goto retry;
+  }
+
+  return cache;
+}
+
 
 /*
  * hb_shape_plan_t
@@ -526,12 +811,12 @@ hb_shape_plan_create_cached2 (hb_face_t                     *face,
 		  num_user_features,
 		  shaper_list);
 
-retry:
-  hb_face_t::plan_node_t *cached_plan_nodes = face->shape_plans;
+  hb_shape_plan_cache_t *cache = nullptr;
+  if (likely (hb_object_is_valid (face)))
+    cache = _hb_face_get_shape_plan_cache (face);
 
-  bool dont_cache = !hb_object_is_valid (face);
-
-  if (likely (!dont_cache))
+  uint32_t hash = 0;
+  if (likely (cache))
   {
     hb_shape_plan_key_t key;
     if (!key.init (false,
@@ -544,12 +829,13 @@ retry:
 		   shaper_list))
       return hb_shape_plan_get_empty ();
 
-    for (hb_face_t::plan_node_t *node = cached_plan_nodes; node; node = node->next)
-      if (node->shape_plan->key.equal (&key))
-      {
-	DEBUG_MSG_FUNC (SHAPE_PLAN, node->shape_plan, "fulfilled from cache");
-	return hb_shape_plan_reference (node->shape_plan);
-      }
+    hash = key.hash ();
+    hb_shape_plan_t *cached_plan = cache->lookup (&key, hash);
+    if (cached_plan)
+    {
+      DEBUG_MSG_FUNC (SHAPE_PLAN, cached_plan, "fulfilled from cache");
+      return cached_plan;
+    }
   }
 
   hb_shape_plan_t *shape_plan = hb_shape_plan_create2 (face, props,
@@ -557,23 +843,82 @@ retry:
 						       coords, num_coords,
 						       shaper_list);
 
-  if (unlikely (dont_cache))
+  if (unlikely (!cache || !hb_object_is_valid (shape_plan)))
     return shape_plan;
 
-  hb_face_t::plan_node_t *node = (hb_face_t::plan_node_t *) hb_calloc (1, sizeof (hb_face_t::plan_node_t));
-  if (unlikely (!node))
-    return shape_plan;
+  bool inserted;
+  shape_plan = cache->insert (shape_plan, hash, &inserted);
+  if (inserted)
+    DEBUG_MSG_FUNC (SHAPE_PLAN, shape_plan, "inserted into cache");
+
+  return shape_plan;
+}
 
-  node->shape_plan = shape_plan;
-  node->next = cached_plan_nodes;
 
-  if (unlikely (!face->shape_plans.cmpexch (cached_plan_nodes, node)))
+/**
+ * hb_shape_plan_cache_set_max_plans:
+ * @face: #hb_face_t to work upon
+ * @max_plans: Maximum number of shape plans to keep cached
+ *
+ * Sets the maximum number of shape plans hb_shape_plan_create_cached2()
+ * keeps around for @face.  When the limit is reached, plans that were
+ * not used recently are dropped from the cache.  Plans still referenced by the
+ * caller stay alive until released.  Setting @max_plans to zero disables
+ * the cache for @face.
+ *
+ * The default is 256 plans.
+ *
+ * This function is thread-safe and can be called on immutable faces.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_shape_plan_cache_set_max_plans (hb_face_t    *face,
+				   unsigned int  max_plans)
+{
+  if (unlikely (!hb_object_is_valid (face)))
+    return;
+
+  hb_shape_plan_cache_t *cache = _hb_face_get_shape_plan_cache (face);
+  if (unlikely (!cache))
+    return;
+
+  cache->set_max_plans (max_plans);
+}
+
+/**
+ * hb_shape_plan_cache_get_stats:
+ * @face: #hb_face_t to work upon
+ * @num_plans: (out) (optional): Number of shape plans currently cached
+ * @hits: (out) (optional): Number of lookups served from the cache
+ * @misses: (out) (optional): Number of lookups that created a new plan
+ * @evictions: (out) (optional): Number of plans dropped to honor the limit
+ *
+ * Fetches statistics about the shape-plan cache of @face.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_shape_plan_cache_get_stats (hb_face_t    *face,
+			       unsigned int *num_plans, /* OUT */
+			       unsigned int *hits,      /* OUT */
+			       unsigned int *misses,    /* OUT */
+			       unsigned int *evictions  /* OUT */)
+{
+  hb_shape_plan_cache_t *cache = face->shape_plans;
+  if (unlikely (!cache))
   {
-    hb_shape_plan_destroy (shape_plan);
-    hb_free (node);
-    goto retry;
+    if (num_plans) *num_plans = 0;
+    if (hits) *hits = 0;
+    if (misses) *misses = 0;
+    if (evictions) *evictions = 0;
+    return;
   }
-  DEBUG_MSG_FUNC (SHAPE_PLAN, shape_plan, "inserted into cache");
 
-  return hb_shape_plan_reference (shape_plan);
+  hb_lock_t l (cache->lock);
+  unsigned int num_misses = cache->misses.get ();
+  if (num_plans) *num_plans = cache->nodes.length;
+  if (hits) *hits = (unsigned) cache->leaves.get () - num_misses;
+  if (misses) *misses = num_misses;
+  if (evictions) *evictions = cache->evictions;
 }
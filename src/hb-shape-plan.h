@@ -84,6 +84,17 @@ hb_shape_plan_create_cached2 (hb_face_t                     *face,
 			      unsigned int                   num_coords,
 			      const char * const            *shaper_list);
 
+HB_EXTERN void
+hb_shape_plan_cache_set_max_plans (hb_face_t    *face,
+				   unsigned int  max_plans);
+
+HB_EXTERN void
+hb_shape_plan_cache_get_stats (hb_face_t    *face,
+			       unsigned int *num_plans, /* OUT */
+			       unsigned int *hits,      /* OUT */
+			       unsigned int *misses,    /* OUT */
+			       unsigned int *evictions  /* OUT */);
+
 
 HB_EXTERN hb_shape_plan_t *
 hb_shape_plan_get_empty (void);
@@ -30,6 +30,8 @@
 #include "hb.hh"
 #include "hb-shaper.hh"
 #include "hb-ot-shape.hh"
+#include "hb-mutex.hh"
+#include "hb-vector.hh"
 
 
 struct hb_shape_plan_key_t
@@ -60,6 +62,8 @@ struct hb_shape_plan_key_t
   HB_INTERNAL bool user_features_match (const hb_shape_plan_key_t *other);
 
   HB_INTERNAL bool equal (const hb_shape_plan_key_t *other);
+
+  HB_INTERNAL uint32_t hash () const;
 };
 
 struct hb_shape_plan_t
@@ -67,10 +71,93 @@ struct hb_shape_plan_t
   hb_object_header_t header;
   hb_face_t *face_unsafe; /* We don't carry a reference to face. */
   hb_shape_plan_key_t key;
+  /* Set by the face's plan cache when used since its last sweep.  Kept
+   * here rather than on the cache node, which gets replaced when the
+   * cache is rehashed while lookups may still be setting it. */
+  hb_atomic_int_t cache_referenced;
 #ifndef HB_NO_OT_SHAPE
   hb_ot_shape_plan_t ot;
 #endif
 };
 
 
+
+#ifndef HB_SHAPE_PLAN_CACHE_MAX_PLANS_DEFAULT
+#define HB_SHAPE_PLAN_CACHE_MAX_PLANS_DEFAULT 256
+#endif
+
+/* Per-face shape-plan cache.  Plans are hashed on their key into
+ * power-of-two buckets; once more than max_plans are cached, plans not
+ * used recently are dropped, using a second-chance (CLOCK) sweep.
+ *
+ * Lookups take no lock: they walk the buckets with atomic loads and
+ * only ever set a plan's cache_referenced bit.  Everything else happens under
+ * the lock.  Nodes, bucket arrays and plans that a lookup may still be
+ * looking at are not freed right away, but kept as garbage until no
+ * lookup is in flight; lookups and leaves count lookups entering and
+ * leaving, which also makes for the hit / miss stats. */
+struct hb_shape_plan_cache_t
+{
+  struct node_t
+  {
+    hb_shape_plan_t *shape_plan;
+    uint32_t hash;
+    hb_atomic_ptr_t<node_t> next;	/* Next in the same bucket. */
+  };
+
+  struct buckets_t
+  {
+    unsigned int length;
+    hb_atomic_ptr_t<node_t> arrayZ[HB_VAR_ARRAY];
+  };
+
+  void init ()
+  {
+    lock.init ();
+    buckets.init ();
+    nodes.init ();
+    hand = 0;
+    max_plans = HB_SHAPE_PLAN_CACHE_MAX_PLANS_DEFAULT;
+    garbage.init ();
+    garbage_plans.init ();
+    lookups.set_relaxed (0);
+    leaves.set_relaxed (0);
+    misses.set_relaxed (0);
+    evictions = 0;
+  }
+  HB_INTERNAL void fini ();
+
+  /* Both return a new reference to the plan to use, if any.  insert()
+   * sets *inserted to whether it added shape_plan to the cache. */
+  HB_INTERNAL hb_shape_plan_t *lookup (const hb_shape_plan_key_t *key, uint32_t hash);
+  HB_INTERNAL hb_shape_plan_t *insert (hb_shape_plan_t *shape_plan, uint32_t hash,
+				       bool *inserted);
+
+  HB_INTERNAL void set_max_plans (unsigned int max_plans);
+
+  private:
+  node_t *find (const hb_shape_plan_key_t *key, uint32_t hash);
+  bool remove (unsigned int i);
+  void shrink (unsigned int max);
+  bool rebuild (unsigned int new_length);
+  void collect_garbage ();
+
+  public:
+  hb_mutex_t lock;
+  hb_atomic_ptr_t<buckets_t> buckets;
+  hb_vector_t<node_t *> nodes;	/* All cached nodes, in sweep order. */
+  unsigned int hand;		/* Sweep position in nodes. */
+  unsigned int max_plans;
+
+  hb_vector_t<void *> garbage;			/* Freed once no lookup is in flight. */
+  hb_vector_t<hb_shape_plan_t *> garbage_plans;	/* Likewise, destroyed. */
+
+  /* Stats; hits are lookups - misses. */
+  hb_atomic_int_t lookups;
+  hb_atomic_int_t leaves;
+  hb_atomic_int_t misses;
+  unsigned int evictions;
+};
+
+
 #endif /* HB_SHAPE_PLAN_HH */
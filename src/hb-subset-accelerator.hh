@@ -0,0 +1,197 @@
+/*
+ * Copyright © 2022  Google, Inc.
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#ifndef HB_SUBSET_ACCELERATOR_HH
+#define HB_SUBSET_ACCELERATOR_HH
+
+#include "hb.hh"
+
+#include "hb-map.hh"
+#include "hb-set.hh"
+#include "hb-mutex.hh"
+
+#include "hb-ot-cmap-table.hh"
+#include "hb-ot-cff1-table.hh"
+#include "hb-ot-cff2-table.hh"
+#include "hb-subset-plan.hh"
+
+
+/*
+ * Source-side data that does not depend on the subset input.  Computed
+ * once by hb_subset_preprocess() and attached to the source face as
+ * user data; every plan created against that face then reuses it.
+ *
+ * Apart from the table and layout index caches, which are guarded by a
+ * lock, it is immutable after creation, so plans may be created and
+ * executed on several threads at once.
+ */
+struct hb_subset_accelerator_t
+{
+  static hb_user_data_key_t *user_data_key ()
+  {
+    static hb_user_data_key_t key;
+    return &key;
+  }
+
+  static hb_subset_accelerator_t *create (hb_face_t *source)
+  {
+    hb_subset_accelerator_t *accel = (hb_subset_accelerator_t *) hb_calloc (1, sizeof (hb_subset_accelerator_t));
+    if (unlikely (!accel)) return nullptr;
+    accel = new (accel) hb_subset_accelerator_t (source);
+    if (unlikely (accel->in_error ()))
+    {
+      destroy (accel);
+      return nullptr;
+    }
+    return accel;
+  }
+
+  static void destroy (void *p)
+  {
+    if (!p) return;
+    hb_subset_accelerator_t *accel = (hb_subset_accelerator_t *) p;
+    accel->~hb_subset_accelerator_t ();
+    hb_free (accel);
+  }
+
+  static const hb_subset_accelerator_t *get (const hb_face_t *face)
+  {
+    return (const hb_subset_accelerator_t *)
+	   hb_face_get_user_data (face, user_data_key ());
+  }
+
+  hb_subset_accelerator_t (hb_face_t *source) : cmap (source)
+#ifndef HB_NO_SUBSET_CFF
+						, cff2 (source)
+#endif
+  {
+    cmap.collect_mapping (hb_set_get_empty (), &unicode_to_gid);
+#ifndef HB_NO_SUBSET_CFF
+    cff1.init (source);
+#endif
+    lock.init ();
+  }
+  ~hb_subset_accelerator_t ()
+  {
+    for (hb_blob_t *blob : tables.values ())
+      hb_blob_destroy (blob);
+    lock.fini ();
+#ifndef HB_NO_SUBSET_CFF
+    cff1.fini ();
+#endif
+  }
+
+  bool in_error () const { return unicode_to_gid.in_error (); }
+
+  /* Returns a reference to the sanitized source table, sanitizing it
+   * only the first time it is asked for. */
+  template <typename T>
+  hb_blob_t *reference_table (hb_face_t *source) const
+  {
+    hb_tag_t tag = T::tableTag;
+    {
+      hb_lock_t l (lock);
+      hb_blob_t *cached = tables.get (tag);
+      if (cached) return hb_blob_reference (cached);
+    }
+
+    hb_blob_t *blob = hb_sanitize_context_t ().reference_table<T> (source);
+
+    hb_lock_t l (lock);
+    hb_blob_t *cached = tables.get (tag);
+    if (cached)
+    {
+      hb_blob_destroy (blob);
+      return hb_blob_reference (cached);
+    }
+    if (tables.set (tag, blob))
+      hb_blob_reference (blob);
+    return blob;
+  }
+
+  /* Layout feature and lookup indices retained for a given set of
+   * layout features; only depends on the features, not the glyphs. */
+  struct layout_indices_t
+  {
+    bool valid;
+    hb_set_t layout_features;
+    hb_set_t lookup_indices;
+    hb_set_t feature_indices;
+  };
+
+  bool get_layout_indices (unsigned table_index,
+			   const hb_set_t *layout_features,
+			   hb_set_t *lookup_indices,
+			   hb_set_t *feature_indices) const
+  {
+    hb_lock_t l (lock);
+    const layout_indices_t &cached = layout_indices[table_index];
+    if (!cached.valid || !cached.layout_features.is_equal (*layout_features))
+      return false;
+    *lookup_indices = cached.lookup_indices;
+    *feature_indices = cached.feature_indices;
+    return true;
+  }
+
+  void set_layout_indices (unsigned table_index,
+			   const hb_set_t *layout_features,
+			   const hb_set_t *lookup_indices,
+			   const hb_set_t *feature_indices) const
+  {
+    hb_lock_t l (lock);
+    layout_indices_t &cached = layout_indices[table_index];
+    cached.layout_features = *layout_features;
+    cached.lookup_indices = *lookup_indices;
+    cached.feature_indices = *feature_indices;
+    cached.valid = !cached.layout_features.in_error () &&
+		   !cached.lookup_indices.in_error () &&
+		   !cached.feature_indices.in_error ();
+  }
+
+  OT::cmap::accelerator_t cmap;
+  hb_map_t unicode_to_gid;	/* Full cmap mapping, as cmap.collect_mapping() gives it. */
+#ifndef HB_NO_SUBSET_CFF
+  OT::cff1::accelerator_subset_t cff1;
+  OT::cff2::accelerator_subset_t cff2;
+#endif
+
+  private:
+  mutable hb_mutex_t lock;
+  mutable hb_hashmap_t<hb_tag_t, hb_blob_t *> tables;
+  mutable layout_indices_t layout_indices[2]; /* GSUB, GPOS */
+};
+
+
+/* Sanitized source table for plan, from its accelerator if it has one. */
+template <typename T>
+static inline hb_blob_t *
+_hb_subset_reference_source_table (const hb_subset_plan_t *plan)
+{
+  if (plan->accelerator)
+    return plan->accelerator->reference_table<T> (plan->source);
+  return hb_sanitize_context_t ().reference_table<T> (plan->source);
+}
+
+
+#endif /* HB_SUBSET_ACCELERATOR_HH */
@@ -34,6 +34,7 @@
 #include "hb-bimap.hh"
 #include "hb-subset-cff1.hh"
 #include "hb-subset-plan.hh"
+#include "hb-subset-accelerator.hh"
 #include "hb-subset-cff-common.hh"
 #include "hb-cff1-interp-cs.hh"
 
@@ -888,6 +889,12 @@ _hb_subset_cff1 (const OT::cff1::accelerator_subset_t  &acc,
 bool
 hb_subset_cff1 (hb_subset_context_t *c)
 {
+  if (c->plan->accelerator)
+  {
+    const OT::cff1::accelerator_subset_t &acc = c->plan->accelerator->cff1;
+    return likely (acc.is_valid ()) && _hb_subset_cff1 (acc, c);
+  }
+
   OT::cff1::accelerator_subset_t acc;
   acc.init (c->plan->source);
   bool result = likely (acc.is_valid ()) && _hb_subset_cff1 (acc, c);
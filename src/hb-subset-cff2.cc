@@ -33,6 +33,7 @@
 #include "hb-set.h"
 #include "hb-subset-cff2.hh"
 #include "hb-subset-plan.hh"
+#include "hb-subset-accelerator.hh"
 #include "hb-subset-cff-common.hh"
 #include "hb-cff2-interp-cs.hh"
 
@@ -450,6 +451,12 @@ _hb_subset_cff2 (const OT::cff2::accelerator_subset_t  &acc,
 bool
 hb_subset_cff2 (hb_subset_context_t *c)
 {
+  if (c->plan->accelerator)
+  {
+    const OT::cff2::accelerator_subset_t &acc = c->plan->accelerator->cff2;
+    return acc.is_valid () && _hb_subset_cff2 (acc, c);
+  }
+
   OT::cff2::accelerator_subset_t acc (c->plan->source);
   return acc.is_valid () && _hb_subset_cff2 (acc, c);
 }
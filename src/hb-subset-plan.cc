@@ -25,6 +25,7 @@
  */
 
 #include "hb-subset-plan.hh"
+#include "hb-subset-accelerator.hh"
 #include "hb-map.hh"
 #include "hb-set.hh"
 
@@ -145,23 +146,59 @@ static void _collect_layout_indices (hb_face_t		  *face,
 		       indices);
 }
 
+template <typename T>
+static void _collect_layout_lookups_and_features (hb_face_t		       *face,
+						  const T&			table,
+						  const hb_set_t	       *layout_features_to_retain,
+						  const hb_subset_accelerator_t *accelerator,
+						  hb_set_t		       *lookup_indices, /* OUT */
+						  hb_set_t		       *feature_indices /* OUT */)
+{
+  unsigned table_index = T::tableTag == HB_OT_TAG_GSUB ? 0 : 1;
+  if (accelerator &&
+      accelerator->get_layout_indices (table_index,
+				       layout_features_to_retain,
+				       lookup_indices,
+				       feature_indices))
+    return;
+
+  _collect_layout_indices<T> (face,
+                              table,
+                              layout_features_to_retain,
+                              hb_ot_layout_collect_lookups,
+                              lookup_indices);
+  _collect_layout_indices<T> (face,
+                              table,
+                              layout_features_to_retain,
+                              hb_ot_layout_collect_features,
+                              feature_indices);
+
+  if (accelerator)
+    accelerator->set_layout_indices (table_index,
+				     layout_features_to_retain,
+				     lookup_indices,
+				     feature_indices);
+}
+
 template <typename T>
 static inline void
-_closure_glyphs_lookups_features (hb_face_t	     *face,
+_closure_glyphs_lookups_features (const hb_subset_plan_t *plan,
 				  hb_set_t	     *gids_to_retain,
 				  const hb_set_t     *layout_features_to_retain,
 				  hb_map_t	     *lookups,
 				  hb_map_t	     *features,
 				  script_langsys_map *langsys_map)
 {
-  hb_blob_ptr_t<T> table = hb_sanitize_context_t ().reference_table<T> (face);
+  hb_face_t *face = plan->source;
+  hb_blob_ptr_t<T> table = _hb_subset_reference_source_table<T> (plan);
   hb_tag_t table_tag = table->tableTag;
-  hb_set_t lookup_indices;
-  _collect_layout_indices<T> (face,
-                              *table,
-                              layout_features_to_retain,
-                              hb_ot_layout_collect_lookups,
-                              &lookup_indices);
+  hb_set_t lookup_indices, feature_indices;
+  _collect_layout_lookups_and_features<T> (face,
+					   *table,
+					   layout_features_to_retain,
+					   plan->accelerator,
+					   &lookup_indices,
+					   &feature_indices);
 
   if (table_tag == HB_OT_TAG_GSUB)
     hb_ot_layout_lookups_substitute_closure (face,
@@ -172,14 +209,7 @@ _closure_glyphs_lookups_features (hb_face_t	     *face,
 			 &lookup_indices);
   _remap_indexes (&lookup_indices, lookups);
 
-  // Collect and prune features
-  hb_set_t feature_indices;
-  _collect_layout_indices<T> (face,
-                              *table,
-                              layout_features_to_retain,
-                              hb_ot_layout_collect_features,
-                              &feature_indices);
-
+  // Prune features
   table->prune_features (lookups, &feature_indices);
   hb_map_t duplicate_feature_map;
   table->find_duplicate_features (lookups, &feature_indices, &duplicate_feature_map);
@@ -195,14 +225,15 @@ _closure_glyphs_lookups_features (hb_face_t	     *face,
 
 #ifndef HB_NO_VAR
 static inline void
-  _collect_layout_variation_indices (hb_face_t *face,
+  _collect_layout_variation_indices (const hb_subset_plan_t *plan,
 				     const hb_set_t *glyphset,
 				     const hb_map_t *gpos_lookups,
 				     hb_set_t  *layout_variation_indices,
 				     hb_map_t  *layout_variation_idx_map)
 {
-  hb_blob_ptr_t<OT::GDEF> gdef = hb_sanitize_context_t ().reference_table<OT::GDEF> (face);
-  hb_blob_ptr_t<OT::GPOS> gpos = hb_sanitize_context_t ().reference_table<OT::GPOS> (face);
+  hb_face_t *face = plan->source;
+  hb_blob_ptr_t<OT::GDEF> gdef = _hb_subset_reference_source_table<OT::GDEF> (plan);
+  hb_blob_ptr_t<OT::GPOS> gpos = _hb_subset_reference_source_table<OT::GPOS> (plan);
 
   if (!gdef->has_data ())
   {
@@ -224,11 +255,17 @@ static inline void
 #endif
 
 static inline void
-_cmap_closure (hb_face_t	   *face,
+_cmap_closure (hb_subset_plan_t   *plan,
 	       const hb_set_t	   *unicodes,
 	       hb_set_t		   *glyphset)
 {
-  OT::cmap::accelerator_t cmap (face);
+  if (plan->accelerator)
+  {
+    plan->accelerator->cmap.table->closure_glyphs (unicodes, glyphset);
+    return;
+  }
+
+  OT::cmap::accelerator_t cmap (plan->source);
   cmap.table->closure_glyphs (unicodes, glyphset);
 }
 
@@ -263,10 +300,10 @@ static void _colr_closure (hb_face_t *face,
 }
 
 static inline void
-_math_closure (hb_face_t           *face,
+_math_closure (const hb_subset_plan_t *plan,
                hb_set_t            *glyphset)
 {
-  hb_blob_ptr_t<OT::MATH> math = hb_sanitize_context_t ().reference_table<OT::MATH> (face);
+  hb_blob_ptr_t<OT::MATH> math = _hb_subset_reference_source_table<OT::MATH> (plan);
   if (math->has_data ())
     math->closure_glyphs (glyphset);
   math.destroy ();
@@ -288,10 +325,10 @@ _remove_invalid_gids (hb_set_t *glyphs,
 static void
 _populate_unicodes_to_retain (const hb_set_t *unicodes,
                               const hb_set_t *glyphs,
+                              const OT::cmap::accelerator_t &cmap,
+                              const hb_map_t *unicode_to_gid, /* May be nullptr. */
                               hb_subset_plan_t *plan)
 {
-  OT::cmap::accelerator_t cmap (plan->source);
-
   constexpr static const int size_threshold = 4096;
 
   if (glyphs->is_empty () && unicodes->get_population () < size_threshold)
@@ -313,10 +350,14 @@ _populate_unicodes_to_retain (const hb_set_t *unicodes,
   else
   {
     hb_map_t unicode_glyphid_map;
-    cmap.collect_mapping (hb_set_get_empty (), &unicode_glyphid_map);
+    if (!unicode_to_gid)
+    {
+      cmap.collect_mapping (hb_set_get_empty (), &unicode_glyphid_map);
+      unicode_to_gid = &unicode_glyphid_map;
+    }
 
     for (hb_pair_t<hb_codepoint_t, hb_codepoint_t> cp_gid :
-	 + unicode_glyphid_map.iter ())
+	 + unicode_to_gid->iter ())
     {
       if (!unicodes->has (cp_gid.first) && !glyphs->has (cp_gid.second))
 	continue;
@@ -340,6 +381,24 @@ _populate_unicodes_to_retain (const hb_set_t *unicodes,
   + plan->codepoint_to_glyph->values () | hb_sink (plan->_glyphset_gsub);
 }
 
+static void
+_populate_unicodes_to_retain (const hb_set_t *unicodes,
+                              const hb_set_t *glyphs,
+                              hb_subset_plan_t *plan)
+{
+  if (plan->accelerator)
+  {
+    _populate_unicodes_to_retain (unicodes, glyphs,
+				  plan->accelerator->cmap,
+				  &plan->accelerator->unicode_to_gid,
+				  plan);
+    return;
+  }
+
+  OT::cmap::accelerator_t cmap (plan->source);
+  _populate_unicodes_to_retain (unicodes, glyphs, cmap, nullptr, plan);
+}
+
 static void
 _populate_gids_to_retain (hb_subset_plan_t* plan,
 			  bool close_over_gsub,
@@ -353,13 +412,13 @@ _populate_gids_to_retain (hb_subset_plan_t* plan,
 
   plan->_glyphset_gsub->add (0); // Not-def
 
-  _cmap_closure (plan->source, plan->unicodes, plan->_glyphset_gsub);
+  _cmap_closure (plan, plan->unicodes, plan->_glyphset_gsub);
 
 #ifndef HB_NO_SUBSET_LAYOUT
   if (close_over_gsub)
     // closure all glyphs/lookups/features needed for GSUB substitutions.
     _closure_glyphs_lookups_features<OT::GSUB> (
-        plan->source,
+        plan,
         plan->_glyphset_gsub,
         plan->layout_features,
         plan->gsub_lookups,
@@ -368,7 +427,7 @@ _populate_gids_to_retain (hb_subset_plan_t* plan,
 
   if (close_over_gpos)
     _closure_glyphs_lookups_features<OT::GPOS> (
-        plan->source,
+        plan,
         plan->_glyphset_gsub,
         plan->layout_features,
         plan->gpos_lookups,
@@ -378,7 +437,7 @@ _populate_gids_to_retain (hb_subset_plan_t* plan,
   _remove_invalid_gids (plan->_glyphset_gsub, plan->source->get_num_glyphs ());
 
   hb_set_set (plan->_glyphset_mathed, plan->_glyphset_gsub);
-  _math_closure (plan->source, plan->_glyphset_mathed);
+  _math_closure (plan, plan->_glyphset_mathed);
   _remove_invalid_gids (plan->_glyphset_mathed, plan->source->get_num_glyphs ());
 
   hb_set_t cur_glyphset = *plan->_glyphset_mathed;
@@ -402,7 +461,7 @@ _populate_gids_to_retain (hb_subset_plan_t* plan,
 
 #ifndef HB_NO_VAR
   if (close_over_gdef)
-    _collect_layout_variation_indices (plan->source,
+    _collect_layout_variation_indices (plan,
 				       plan->_glyphset_gsub,
 				       plan->gpos_lookups,
 				       plan->layout_variation_indices,
@@ -480,7 +539,7 @@ hb_subset_plan_create_or_fail (hb_face_t	 *face,
   if (unlikely (!(plan = hb_object_create<hb_subset_plan_t> ())))
     return nullptr;
 
-  plan->successful = true;
+  plan->successful.set_relaxed (true);
   plan->flags = input->flags;
   plan->unicodes = hb_set_create ();
   plan->name_ids = hb_set_copy (input->sets.name_ids);
@@ -492,6 +551,7 @@ hb_subset_plan_create_or_fail (hb_face_t	 *face,
   plan->no_subset_tables = hb_set_copy (input->sets.no_subset_tables);
   plan->source = hb_face_reference (face);
   plan->dest = hb_face_builder_create ();
+  plan->accelerator = hb_subset_accelerator_t::get (face);
 
   plan->_glyphset = hb_set_create ();
   plan->_glyphset_gsub = hb_set_create ();
@@ -34,12 +34,16 @@
 
 #include "hb-map.hh"
 #include "hb-set.hh"
+#include "hb-mutex.hh"
+
+struct hb_subset_accelerator_t;
 
 struct hb_subset_plan_t
 {
   hb_object_header_t header;
 
-  bool successful;
+  // Atomic, since tables may be subset concurrently.
+  hb_atomic_int_t successful;
   unsigned flags;
 
   // For each cp that we'd like to retain maps to the corresponding gid.
@@ -74,6 +78,9 @@ struct hb_subset_plan_t
   hb_face_t *source;
   hb_face_t *dest;
 
+  // Source-side data from hb_subset_preprocess(), if any; owned by source.
+  const hb_subset_accelerator_t *accelerator;
+
   unsigned int _num_output_glyphs;
   hb_set_t *_glyphset;
   hb_set_t *_glyphset_gsub;
@@ -101,14 +108,24 @@ struct hb_subset_plan_t
   //Old -> New layout item variation store delta set index mapping
   hb_map_t *layout_variation_idx_map;
 
+  // While tables are being subset concurrently, output tables are
+  // collected here instead of going straight to the face builder.
+  struct table_staging_t
+  {
+    hb_mutex_t lock;
+    hb_vector_t<hb_pair_t<hb_tag_t, hb_blob_t *>> tables;
+  };
+  table_staging_t *staging;
+
  public:
 
-  bool in_error () const { return !successful; }
+  bool in_error () const { return !successful.get_relaxed (); }
 
   bool check_success(bool success)
   {
-    successful = (successful && success);
-    return successful;
+    if (unlikely (!success))
+      successful.set_relaxed (false);
+    return !in_error ();
   }
 
   /*
@@ -194,6 +211,12 @@ struct hb_subset_plan_t
 		hb_blob_get_length (source_blob));
       hb_blob_destroy (source_blob);
     }
+    if (staging)
+    {
+      hb_lock_t lock (staging->lock);
+      staging->tables.push (hb_pair (tag, hb_blob_reference (contents)));
+      return !staging->tables.in_error ();
+    }
     return hb_face_builder_add_table (dest, tag, contents);
   }
 };
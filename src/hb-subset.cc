@@ -28,6 +28,7 @@
 #include "hb-open-type.hh"
 
 #include "hb-subset.hh"
+#include "hb-subset-accelerator.hh"
 
 #include "hb-open-file.hh"
 #include "hb-ot-cmap-table.hh"
@@ -55,6 +56,15 @@
 #include "hb-ot-math-table.hh"
 #include "hb-repacker.hh"
 
+#if !defined(HB_NO_MT) && !defined(HB_NO_SUBSET_THREADS) && defined(HAVE_PTHREAD)
+#define HB_SUBSET_THREADS 1
+#include <pthread.h>
+#endif
+
+#ifndef HB_SUBSET_MAX_THREADS
+#define HB_SUBSET_MAX_THREADS 4
+#endif
+
 /**
  * SECTION:hb-subset
  * @title: hb-subset
@@ -153,7 +163,7 @@ template<typename TableType>
 static bool
 _subset (hb_subset_plan_t *plan)
 {
-  hb_blob_t *source_blob = hb_sanitize_context_t ().reference_table<TableType> (plan->source);
+  hb_blob_t *source_blob = _hb_subset_reference_source_table<TableType> (plan);
   const TableType *table = source_blob->as<TableType> ();
 
   hb_tag_t tag = TableType::tableTag;
@@ -328,6 +338,107 @@ _subset_table (hb_subset_plan_t *plan, hb_tag_t tag)
   }
 }
 
+#ifdef HB_SUBSET_THREADS
+struct hb_subset_tables_job_t
+{
+  hb_subset_plan_t *plan;
+  hb_array_t<const hb_tag_t> tags;
+  hb_atomic_int_t next;
+  hb_atomic_int_t failed;
+};
+
+static void *
+_subset_tables_worker (void *arg)
+{
+  hb_subset_tables_job_t *job = (hb_subset_tables_job_t *) arg;
+  while (!job->failed.get_relaxed ())
+  {
+    unsigned i = job->next.inc ();
+    if (i >= job->tags.length) break;
+    if (unlikely (!_subset_table (job->plan, job->tags[i])))
+      job->failed.set_relaxed (1);
+  }
+  return nullptr;
+}
+
+static int
+_compare_staged_tables (const void *pa, const void *pb)
+{
+  hb_tag_t a = ((const hb_pair_t<hb_tag_t, hb_blob_t *> *) pa)->first;
+  hb_tag_t b = ((const hb_pair_t<hb_tag_t, hb_blob_t *> *) pb)->first;
+  return a < b ? -1 : a > b ? 1 : 0;
+}
+
+/*
+ * Subsets tables on up to HB_SUBSET_MAX_THREADS threads, the calling
+ * thread included.  The workers share the plan: its sets and maps are
+ * only queried, the success flag and the sets' iteration hints are
+ * atomic, and the output tables are staged and added to the face
+ * builder in tag order once all workers are done.
+ */
+static bool
+_subset_tables_concurrently (hb_subset_plan_t *plan,
+			     hb_array_t<const hb_tag_t> tags)
+{
+  /* hb_set_t caches its population on first use; do that now,
+   * before the sets are shared between threads. */
+  for (const hb_set_t *set : {plan->unicodes,
+			      plan->name_ids,
+			      plan->name_languages,
+			      plan->layout_features,
+			      plan->glyphs_requested,
+			      plan->no_subset_tables,
+			      plan->drop_tables,
+			      plan->_glyphset,
+			      plan->_glyphset_gsub,
+			      plan->_glyphset_mathed,
+			      plan->_glyphset_colred,
+			      plan->layout_variation_indices})
+    set->get_population ();
+  for (const hb_set_t *set : plan->gsub_langsys->values ())
+    set->get_population ();
+  for (const hb_set_t *set : plan->gpos_langsys->values ())
+    set->get_population ();
+
+  hb_subset_plan_t::table_staging_t staging;
+  staging.lock.init ();
+  plan->staging = &staging;
+
+  hb_subset_tables_job_t job;
+  job.plan = plan;
+  job.tags = tags;
+  job.next.set_relaxed (0);
+  job.failed.set_relaxed (0);
+
+  pthread_t threads[HB_SUBSET_MAX_THREADS - 1];
+  unsigned num_threads = 0;
+  unsigned max_threads = hb_min (tags.length, (unsigned) HB_SUBSET_MAX_THREADS) - 1;
+  while (num_threads < max_threads &&
+	 !pthread_create (&threads[num_threads], nullptr, _subset_tables_worker, &job))
+    num_threads++;
+
+  _subset_tables_worker (&job);
+
+  for (unsigned i = 0; i < num_threads; i++)
+    pthread_join (threads[i], nullptr);
+
+  plan->staging = nullptr;
+  staging.lock.fini ();
+
+  bool success = !job.failed.get () && !staging.tables.in_error ();
+  staging.tables.qsort (_compare_staged_tables);
+  for (auto &entry : staging.tables)
+  {
+    if (success)
+      success = plan->add_table (entry.first, entry.second);
+    hb_blob_destroy (entry.second);
+  }
+  staging.tables.fini ();
+
+  return success;
+}
+#endif
+
 /**
  * hb_subset_or_fail:
  * @source: font face data to be subset.
@@ -354,6 +465,45 @@ hb_subset_or_fail (hb_face_t *source, const hb_subset_input_t *input)
 }
 
 
+/**
+ * hb_subset_preprocess:
+ * @source: a #hb_face_t object.
+ *
+ * Precomputes the data that subsetting needs from @source but that
+ * does not depend on the subset input, such as the cmap mapping, the
+ * layout lookups retained for a set of features, and the parsed CFF
+ * tables.  The data is attached to @source, and reused by every
+ * subsetting plan subsequently created for it.
+ *
+ * This is useful when the same font is subset repeatedly; a one-off
+ * subset does not benefit from it.
+ *
+ * Return value: (transfer full): a new reference to @source, to be
+ * used as the source face of subsequent subset operations.
+ *
+ * Since: REPLACEME
+ **/
+hb_face_t *
+hb_subset_preprocess (hb_face_t *source)
+{
+  if (unlikely (!source)) return hb_face_get_empty ();
+
+  if (!hb_subset_accelerator_t::get (source))
+  {
+    hb_subset_accelerator_t *accel = hb_subset_accelerator_t::create (source);
+    if (accel &&
+	!hb_face_set_user_data (source,
+				hb_subset_accelerator_t::user_data_key (),
+				accel,
+				hb_subset_accelerator_t::destroy,
+				false))
+      /* Raced with another thread, or source is the empty face. */
+      hb_subset_accelerator_t::destroy (accel);
+  }
+
+  return hb_face_reference (source);
+}
+
 /**
  * hb_subset_plan_execute_or_fail:
  * @plan: a subsetting plan.
@@ -374,6 +524,7 @@ hb_subset_plan_execute_or_fail (hb_subset_plan_t *plan)
   }
 
   hb_set_t tags_set;
+  hb_vector_t<hb_tag_t> tags;
   bool success = true;
   hb_tag_t table_tags[32];
   unsigned offset = 0, num_tables = ARRAY_LENGTH (table_tags);
@@ -384,12 +535,23 @@ hb_subset_plan_execute_or_fail (hb_subset_plan_t *plan)
       hb_tag_t tag = table_tags[i];
       if (_should_drop_table (plan, tag) && !tags_set.has (tag)) continue;
       tags_set.add (tag);
-      success = _subset_table (plan, tag);
-      if (unlikely (!success)) goto end;
+      tags.push (tag);
     }
     offset += num_tables;
   }
-end:
+  if (unlikely (tags.in_error ()))
+    return nullptr;
+
+#ifdef HB_SUBSET_THREADS
+  if ((plan->flags & HB_SUBSET_FLAGS_PARALLEL_TABLES) && tags.length > 1)
+    success = _subset_tables_concurrently (plan, tags.as_array ());
+  else
+#endif
+  for (hb_tag_t tag : tags)
+  {
+    success = _subset_table (plan, tag);
+    if (unlikely (!success)) break;
+  }
 
   return success ? hb_face_reference (plan->dest) : nullptr;
 }
@@ -232,6 +232,14 @@ void free_static_ucd_funcs ()
   static_ucd_funcs.free_instance ();
 }
 
+bool
+_hb_ucd_has_decomposition (hb_codepoint_t u)
+{
+  /* Nothing below U+00C0 has a canonical decomposition. */
+  if (likely (u < 0x00C0u)) return false;
+  return u - SBASE < SCOUNT || _hb_ucd_dm (u);
+}
+
 hb_unicode_funcs_t *
 hb_ucd_get_unicode_funcs ()
 {
@@ -402,5 +402,14 @@ _hb_unicode_is_emoji_Extended_Pictographic (hb_codepoint_t cp);
 
 extern "C" HB_INTERNAL hb_unicode_funcs_t *hb_ucd_get_unicode_funcs ();
 
+/*
+ * Normalization quick-check.
+ */
+
+/* Returns whether u has a canonical decomposition in our UCD data, ie.
+ * whether hb_ucd_get_unicode_funcs() may decompose it.  Like NFD_QC=No. */
+HB_INTERNAL bool
+_hb_ucd_has_decomposition (hb_codepoint_t u);
+
 
 #endif /* HB_UNICODE_HH */
@@ -191,7 +191,7 @@ struct hb_vector_t : std::conditional<sorted, hb_vector_t<Type, false>, hb_empty
   {
     /* TODO Emplace? */
     Type *p = push ();
-    if (p == &Crap (Type))
+    if (unlikely (in_error ()))
       // If push failed to allocate then don't copy v, since this may cause
       // the created copy to leak memory since we won't have stored a
       // reference to it.
@@ -201,6 +201,8 @@ struct hb_vector_t : std::conditional<sorted, hb_vector_t<Type, false>, hb_empty
   }
 
   bool in_error () const { return allocated < 0; }
+  /* Number of items there is room for without reallocating. */
+  unsigned int get_allocated () const { return in_error () ? 0 : allocated; }
 
   template <typename T = Type,
 	    hb_enable_if (std::is_trivially_copy_assignable<T>::value)>
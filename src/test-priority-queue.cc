@@ -73,6 +73,58 @@ test_extract ()
   assert (queue.is_empty ());
 }
 
+static void
+test_insert_or_decrease ()
+{
+  hb_priority_queue_t queue;
+  queue.insert (40, 0);
+  queue.insert (30, 1);
+  queue.insert (20, 2);
+  queue.insert (10, 3);
+  assert (queue.contains (2));
+  assert (!queue.contains (4));
+
+  queue.insert_or_decrease (5, 0);
+  assert (queue.minimum () == hb_pair (5, 0));
+
+  // Raising the priority of a queued value does nothing.
+  queue.insert_or_decrease (50, 3);
+  queue.insert_or_decrease (15, 4);
+  assert (queue.get_population () == 5);
+
+  assert (queue.pop_minimum () == hb_pair (5, 0));
+  assert (!queue.contains (0));
+  assert (queue.pop_minimum () == hb_pair (10, 3));
+  assert (queue.pop_minimum () == hb_pair (15, 4));
+  assert (queue.pop_minimum () == hb_pair (20, 2));
+  assert (queue.pop_minimum () == hb_pair (30, 1));
+  assert (queue.is_empty ());
+
+  // Popped values can be queued again.
+  queue.insert_or_decrease (7, 0);
+  assert (queue.pop_minimum () == hb_pair (7, 0));
+}
+
+static void
+test_extract_many ()
+{
+  hb_priority_queue_t queue;
+  for (unsigned i = 0; i < 1000; i++)
+    queue.insert ((i * 7919) % 1000, i);
+  for (unsigned i = 0; i < 1000; i += 3)
+    queue.insert_or_decrease ((int64_t) ((i * 7919) % 1000) - 1000, i);
+
+  int64_t last = -1000;
+  for (unsigned i = 0; i < 1000; i++)
+  {
+    auto item = queue.pop_minimum ();
+    assert (item.first >= last);
+    assert (item.first == (int64_t) ((item.second * 7919) % 1000) - (item.second % 3 ? 0 : 1000));
+    last = item.first;
+  }
+  assert (queue.is_empty ());
+}
+
 static void
 test_extract_empty ()
 {
@@ -85,5 +137,7 @@ main (int argc, char **argv)
 {
   test_insert ();
   test_extract ();
+  test_insert_or_decrease ();
+  test_extract_many ();
   test_extract_empty ();
 }
@@ -114,6 +114,72 @@ test_aat_has (void)
   hb_face_destroy (trak);
 }
 
+static hb_bool_t
+collect_skipped_subtables (hb_buffer_t *buffer HB_UNUSED,
+			   hb_font_t *font HB_UNUSED,
+			   const char *message,
+			   void *user_data)
+{
+  char *skipped = (char *) user_data;
+  if (!strncmp (message, "skipped ", 8) &&
+      strlen (skipped) + strlen (message) < 256)
+  {
+    strcat (skipped, message + 8);
+    strcat (skipped, ";");
+  }
+  return TRUE;
+}
+
+static void
+shape_aat_digest (hb_font_t *font, const char *text,
+		  const char *expected_glyphs, const char *expected_skipped)
+{
+  hb_buffer_t *buffer = hb_buffer_create ();
+  char skipped[256] = "";
+  char glyphs[128];
+
+  hb_buffer_add_utf8 (buffer, text, -1, 0, -1);
+  hb_buffer_guess_segment_properties (buffer);
+  hb_buffer_set_message_func (buffer, collect_skipped_subtables, skipped, NULL);
+  hb_shape (font, buffer, NULL, 0);
+
+  hb_buffer_serialize_glyphs (buffer, 0, hb_buffer_get_length (buffer),
+			      glyphs, sizeof (glyphs), NULL, font,
+			      HB_BUFFER_SERIALIZE_FORMAT_TEXT,
+			      HB_BUFFER_SERIALIZE_FLAG_NO_GLYPH_NAMES |
+			      HB_BUFFER_SERIALIZE_FLAG_NO_CLUSTERS);
+  g_assert_cmpstr (glyphs, ==, expected_glyphs);
+  g_assert_cmpstr (skipped, ==, expected_skipped);
+
+  hb_buffer_destroy (buffer);
+}
+
+static void
+test_aat_subtable_digests (void)
+{
+  /* The morx chain has three subtables: 0 turns x into b, 1 turns b
+   * into c, and 2 marks every glyph and, at end of text, turns the
+   * marked one from a into d.  Subtable 2 has no class for any glyph,
+   * but acts at end of text, so it always runs.  The kerx table has two
+   * pair subtables, a-c and c-d. */
+  hb_face_t *face = hb_test_open_font_file ("fonts/aat-digest.ttf");
+  hb_font_t *font = hb_font_create (face);
+
+  shape_aat_digest (font, "a", "[5+500]",
+		    "chainsubtable 0 because no glyph matches;"
+		    "chainsubtable 1 because no glyph matches;"
+		    "subtable 0 because no glyph matches;"
+		    "subtable 1 because no glyph matches;");
+  shape_aat_digest (font, "ab", "[1+450|3@-50,0+450]",
+		    "chainsubtable 0 because no glyph matches;");
+  /* The b that subtable 0 makes has to reach subtable 1. */
+  shape_aat_digest (font, "xa", "[3+400|5@-100,0+400]",
+		    "subtable 0 because no glyph matches;");
+
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -123,6 +189,7 @@ main (int argc, char **argv)
   hb_test_add (test_aat_get_feature_types);
   hb_test_add (test_aat_get_feature_selectors);
   hb_test_add (test_aat_has);
+  hb_test_add (test_aat_subtable_digests);
 
   face = hb_test_open_font_file ("fonts/aat-feat.ttf");
   sbix = hb_test_open_font_file ("fonts/chromacheck-sbix.ttf");
@@ -812,6 +812,42 @@ test_buffer_utf32_conversion (void)
 }
 
 
+static void
+test_buffer_utf8_long (void)
+{
+  /* Long enough for sequences to straddle the chunks text is decoded in. */
+  static const char pattern[] = "a\xE2\x82\xAC\xF0\x9F\x98\x80\xFF" "b";
+  static const hb_codepoint_t pattern_codepoints[] = {0x61, 0x20AC, 0x1F600, 0xFFFD, 0x62};
+  static const unsigned int pattern_clusters[] = {0, 1, 4, 8, 9};
+  unsigned int pattern_len = sizeof (pattern) - 1;
+  unsigned int repeats = 1000;
+  unsigned int bytes = pattern_len * repeats;
+  hb_buffer_t *b;
+  hb_glyph_info_t *glyphs;
+  char *text;
+  unsigned int i, len;
+
+  text = g_malloc (bytes);
+  for (i = 0; i < repeats; i++)
+    memcpy (text + i * pattern_len, pattern, pattern_len);
+
+  b = hb_buffer_create ();
+  hb_buffer_add_utf8 (b, text, bytes, 0, bytes - pattern_len);
+
+  glyphs = hb_buffer_get_glyph_infos (b, &len);
+  g_assert_cmpint (len, ==, (repeats - 1) * G_N_ELEMENTS (pattern_codepoints));
+  for (i = 0; i < len; i++)
+  {
+    unsigned int k = i % G_N_ELEMENTS (pattern_codepoints);
+    g_assert_cmphex (glyphs[i].codepoint, ==, pattern_codepoints[k]);
+    g_assert_cmpint (glyphs[i].cluster, ==, i / G_N_ELEMENTS (pattern_codepoints) * pattern_len + pattern_clusters[k]);
+  }
+
+  hb_buffer_destroy (b);
+  g_free (text);
+}
+
+
 static void
 test_empty (hb_buffer_t *b)
 {
@@ -945,6 +981,7 @@ main (int argc, char **argv)
 
   hb_test_add (test_buffer_utf8_conversion);
   hb_test_add (test_buffer_utf8_validity);
+  hb_test_add (test_buffer_utf8_long);
   hb_test_add (test_buffer_utf16_conversion);
   hb_test_add (test_buffer_utf32_conversion);
   hb_test_add (test_buffer_empty);
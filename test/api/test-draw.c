@@ -26,6 +26,7 @@
 #include <math.h>
 
 #include <hb.h>
+#include <hb-ot.h>
 #ifdef HAVE_FREETYPE
 #include <hb-ft.h>
 #endif
@@ -332,6 +333,188 @@ test_hb_draw_cff2 (void)
   hb_font_destroy (font);
 }
 
+static void
+test_hb_draw_cff2_outline_cache (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/AdobeVFPrototype.abc.otf");
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+
+  g_assert (hb_ot_font_set_outline_cache_budget (font, 1 << 16));
+
+  char str[1024];
+  draw_data_t draw_data = {
+    .str = str,
+    .size = sizeof (str)
+  };
+
+  /* Drawn twice: once recording the outline, once replaying it. */
+  char expected[] = "M275,442C303,442 337,435 371,417L325,454L350,366"
+		    "C357,341 370,321 403,321C428,321 443,333 448,358"
+		    "C435,432 361,487 272,487C153,487 43,393 43,236"
+		    "C43,83 129,-13 266,-13C360,-13 424,33 451,116L427,128"
+		    "C396,78 345,50 287,50C193,50 126,119 126,245C126,373 188,442 275,442Z";
+  for (unsigned i = 0; i < 2; i++)
+  {
+    draw_data.consumed = 0;
+    hb_font_get_glyph_shape (font, 3, funcs, &draw_data);
+    g_assert_cmpmem (str, draw_data.consumed, expected, sizeof (expected) - 1);
+  }
+
+  /* Cached outlines are in font units. */
+  hb_font_set_scale (font, 2000, 2000);
+  draw_data.consumed = 0;
+  hb_font_get_glyph_shape (font, 3, funcs, &draw_data);
+  g_assert_cmpmem (str, 5, "M550,", 5);
+  hb_font_set_scale (font, 1000, 1000);
+
+  /* ... but depend on the variation coordinates. */
+  hb_variation_t var;
+  var.tag = HB_TAG ('w','g','h','t');
+  var.value = 800;
+  hb_font_set_variations (font, &var, 1);
+
+  char expected2[] = "M323,448C356,448 380,441 411,427L333,469L339,401"
+		     "C343,322 379,297 420,297C458,297 480,314 492,352"
+		     "C486,433 412,501 303,501C148,501 25,406 25,241"
+		     "C25,70 143,-16 279,-16C374,-16 447,22 488,103L451,137"
+		     "C423,107 390,86 344,86C262,86 209,148 209,261C209,398 271,448 323,448Z";
+  for (unsigned i = 0; i < 2; i++)
+  {
+    draw_data.consumed = 0;
+    hb_font_get_glyph_shape (font, 3, funcs, &draw_data);
+    g_assert_cmpmem (str, draw_data.consumed, expected2, sizeof (expected2) - 1);
+  }
+
+  g_assert (hb_ot_font_set_outline_cache_budget (font, 0));
+
+  hb_font_destroy (font);
+}
+
+/* Feeds an outline from hb_font_get_glyph_outlines() to the callbacks above,
+ * for comparing with what hb_font_get_glyph_shape() draws. */
+static void
+_replay_outline (const uint8_t *commands, unsigned command_count,
+		 const float *coords, draw_data_t *draw_data)
+{
+  for (unsigned i = 0; i < command_count; i++)
+    switch (commands[i])
+    {
+    case HB_DRAW_COMMAND_MOVE_TO:
+      move_to (NULL, draw_data, NULL, coords[0], coords[1], NULL);
+      coords += 2;
+      break;
+    case HB_DRAW_COMMAND_LINE_TO:
+      line_to (NULL, draw_data, NULL, coords[0], coords[1], NULL);
+      coords += 2;
+      break;
+    case HB_DRAW_COMMAND_QUADRATIC_TO:
+      quadratic_to (NULL, draw_data, NULL, coords[0], coords[1], coords[2], coords[3], NULL);
+      coords += 4;
+      break;
+    case HB_DRAW_COMMAND_CUBIC_TO:
+      cubic_to (NULL, draw_data, NULL, coords[0], coords[1], coords[2], coords[3], coords[4], coords[5], NULL);
+      coords += 6;
+      break;
+    case HB_DRAW_COMMAND_CLOSE_PATH:
+      close_path (NULL, draw_data, NULL, NULL);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static void
+test_hb_draw_glyph_outlines (void)
+{
+  const char *font_files[] = {
+    "fonts/SourceSerifVariable-Roman-VVAR.abc.ttf",
+    "fonts/SourceSansPro-Regular.otf",
+    "fonts/AdobeVFPrototype.abc.otf",
+  };
+  for (unsigned f = 0; f < G_N_ELEMENTS (font_files); f++)
+  {
+    hb_face_t *face = hb_test_open_font_file (font_files[f]);
+    hb_font_t *font = hb_font_create (face);
+    hb_face_destroy (face);
+
+    hb_variation_t var;
+    var.tag = HB_TAG ('w','g','h','t');
+    var.value = 800;
+    hb_font_set_variations (font, &var, 1);
+
+    hb_codepoint_t glyphs[4];
+    unsigned glyph_count = MIN (G_N_ELEMENTS (glyphs), hb_face_get_glyph_count (face));
+    for (unsigned i = 0; i < glyph_count; i++)
+      glyphs[i] = i;
+
+    uint8_t commands[512];
+    float coords[2048];
+    unsigned ends[G_N_ELEMENTS (glyphs)];
+    unsigned command_count = sizeof (commands);
+    unsigned coord_count = G_N_ELEMENTS (coords);
+    g_assert_cmpuint (hb_font_get_glyph_outlines (font, glyph_count, glyphs, sizeof (glyphs[0]), ends,
+						  &command_count, commands,
+						  &coord_count, coords), ==, glyph_count);
+    g_assert_cmpuint (ends[glyph_count - 1], ==, command_count);
+
+    unsigned start = 0;
+    const float *glyph_coords = coords;
+    for (unsigned i = 0; i < glyph_count; i++)
+    {
+      char expected[2048];
+      draw_data_t expected_data = {
+	.str = expected,
+	.size = sizeof (expected)
+      };
+      hb_font_get_glyph_shape (font, glyphs[i], funcs, &expected_data);
+
+      char str[2048];
+      draw_data_t draw_data = {
+	.str = str,
+	.size = sizeof (str)
+      };
+      _replay_outline (commands + start, ends[i] - start, glyph_coords, &draw_data);
+      g_assert_cmpmem (str, draw_data.consumed, expected, expected_data.consumed);
+
+      for (; start < ends[i]; start++)
+	glyph_coords += commands[start] == HB_DRAW_COMMAND_CUBIC_TO ? 6 :
+			commands[start] == HB_DRAW_COMMAND_QUADRATIC_TO ? 4 :
+			commands[start] == HB_DRAW_COMMAND_CLOSE_PATH ? 0 : 2;
+    }
+    g_assert (glyph_coords == coords + coord_count);
+
+    /* Outlines that don't fit are left out whole. */
+    unsigned needed = ends[glyph_count - 1];
+    command_count = ends[glyph_count - 1] - 1;
+    coord_count = G_N_ELEMENTS (coords);
+    g_assert_cmpuint (hb_font_get_glyph_outlines (font, glyph_count, glyphs, sizeof (glyphs[0]), NULL,
+						  &command_count, commands,
+						  &coord_count, coords), ==, glyph_count - 1);
+    g_assert_cmpuint (command_count, ==, ends[glyph_count - 2]);
+    g_assert_cmpuint (command_count, <, needed);
+
+    /* Retrying with a glyph that doesn't fit reports the room it needs. */
+    unsigned last_commands = ends[glyph_count - 1] - ends[glyph_count - 2];
+    unsigned last_coords = (glyph_coords - coords) - coord_count;
+    g_assert_cmpuint (last_commands, >, 0);
+    command_count = last_commands - 1;
+    coord_count = G_N_ELEMENTS (coords);
+    g_assert_cmpuint (hb_font_get_glyph_outlines (font, 1, &glyphs[glyph_count - 1], 0, NULL,
+						  &command_count, commands,
+						  &coord_count, coords), ==, 0);
+    g_assert_cmpuint (command_count, ==, last_commands);
+    g_assert_cmpuint (coord_count, ==, last_coords);
+    g_assert_cmpuint (hb_font_get_glyph_outlines (font, 1, &glyphs[glyph_count - 1], 0, NULL,
+						  &command_count, commands,
+						  &coord_count, coords), ==, 1);
+    g_assert_cmpuint (command_count, ==, last_commands);
+    g_assert_cmpuint (coord_count, ==, last_coords);
+
+    hb_font_destroy (font);
+  }
+}
+
 static void
 test_hb_draw_ttf_parser_tests (void)
 {
@@ -1147,6 +1330,8 @@ main (int argc, char **argv)
   hb_test_add (test_hb_draw_cff1);
   hb_test_add (test_hb_draw_cff1_rline);
   hb_test_add (test_hb_draw_cff2);
+  hb_test_add (test_hb_draw_cff2_outline_cache);
+  hb_test_add (test_hb_draw_glyph_outlines);
   hb_test_add (test_hb_draw_ttf_parser_tests);
   hb_test_add (test_hb_draw_font_kit_glyphs_tests);
   hb_test_add (test_hb_draw_font_kit_variations_tests);
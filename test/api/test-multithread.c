@@ -40,14 +40,20 @@ static int num_iters = 200;
 static hb_font_t *font;
 static hb_buffer_t *ref_buffer;
 
+/* If set, shape with one of eight features the font does not have, so
+ * that each needs its own shape plan. */
+static hb_bool_t vary_features = FALSE;
+
 static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static void
-fill_the_buffer (hb_buffer_t *buffer)
+fill_the_buffer (hb_buffer_t *buffer, unsigned variant)
 {
+  hb_feature_t feature = { HB_TAG ('x','x','x','0' + variant % 8), 1, 0, (unsigned) -1 };
+
   hb_buffer_add_utf8 (buffer, text, -1, 0, -1);
   hb_buffer_guess_segment_properties (buffer);
-  hb_shape (font, buffer, NULL, 0);
+  hb_shape (font, buffer, &feature, vary_features ? 1 : 0);
 }
 
 static void
@@ -85,7 +91,7 @@ thread_func (void *data)
   for (i = 0; i < num_iters; i++)
   {
     hb_buffer_clear_contents (buffer);
-    fill_the_buffer (buffer);
+    fill_the_buffer (buffer, i);
     validity_check (buffer);
   }
 
@@ -143,7 +149,7 @@ main (int argc, char **argv)
 
   /* Fill the reference */
   ref_buffer = hb_buffer_create ();
-  fill_the_buffer (ref_buffer);
+  fill_the_buffer (ref_buffer, 0);
 
   /* Unnecessary, since version 2 it is ot-font by default */
   hb_ot_font_set_funcs (font);
@@ -153,6 +159,11 @@ main (int argc, char **argv)
   hb_ft_font_set_funcs (font);
   test_body ();
 
+  /* Test the shape-plan cache evicting plans while they are looked up */
+  hb_shape_plan_cache_set_max_plans (face, 4);
+  vary_features = TRUE;
+  test_body ();
+
   hb_buffer_destroy (ref_buffer);
 
   hb_font_destroy (font);
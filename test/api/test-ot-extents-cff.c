@@ -215,6 +215,55 @@ test_extents_cff2_vsindex_named_instance (void)
   hb_font_destroy (font);
 }
 
+static void
+test_extents_cff2_changing_font (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/AdobeVFPrototype_vsindex.otf");
+  g_assert (face);
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+  g_assert (font);
+  hb_ot_font_set_funcs (font);
+
+  /* Extents fetched before must not be reused after the font changes. */
+  hb_glyph_extents_t  extents;
+  hb_bool_t result = hb_font_get_glyph_extents (font, 1, &extents);
+  g_assert (result);
+
+  hb_font_set_var_named_instance (font, 6); // 6 (BlackMediumContrast): 900, 50
+  result = hb_font_get_glyph_extents (font, 1, &extents);
+  g_assert (result);
+
+  g_assert_cmpint (extents.x_bearing, ==, 13);
+  g_assert_cmpint (extents.y_bearing, ==, 652);
+  g_assert_cmpint (extents.width, ==, 652);
+  g_assert_cmpint (extents.height, ==, -652);
+
+  hb_font_set_scale (font, 2000, 2000);
+  result = hb_font_get_glyph_extents (font, 1, &extents);
+  g_assert (result);
+
+  /* Compare against extents computed with no cache at all. */
+  hb_font_t *fresh_font = hb_font_create (hb_font_get_face (font));
+  hb_ot_font_set_funcs (fresh_font);
+  g_assert (hb_ot_font_set_extents_cache_enabled (fresh_font, FALSE));
+  g_assert (!hb_ot_font_set_extents_cache_enabled (hb_font_get_empty (), FALSE));
+  hb_font_set_var_named_instance (fresh_font, 6);
+  hb_font_set_scale (fresh_font, 2000, 2000);
+  hb_glyph_extents_t  fresh_extents;
+  result = hb_font_get_glyph_extents (fresh_font, 1, &fresh_extents);
+  g_assert (result);
+
+  g_assert_cmpint (extents.x_bearing, ==, fresh_extents.x_bearing);
+  g_assert_cmpint (extents.y_bearing, ==, fresh_extents.y_bearing);
+  g_assert_cmpint (extents.width, ==, fresh_extents.width);
+  g_assert_cmpint (extents.height, ==, fresh_extents.height);
+  g_assert_cmpint (extents.y_bearing, !=, 652);
+
+  hb_font_destroy (fresh_font);
+  hb_font_destroy (font);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -226,6 +275,7 @@ main (int argc, char **argv)
   hb_test_add (test_extents_cff2);
   hb_test_add (test_extents_cff2_vsindex);
   hb_test_add (test_extents_cff2_vsindex_named_instance);
+  hb_test_add (test_extents_cff2_changing_font);
 
   return hb_test_run ();
 }
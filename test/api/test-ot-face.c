@@ -44,6 +44,7 @@ test_font (hb_font_t *font, hb_codepoint_t cp)
   hb_position_t x = 0, y = 0;
   char buf[5] = {0};
   unsigned int len = 0;
+  unsigned int hits = 0, misses = 0;
   hb_glyph_extents_t extents = {0};
   hb_ot_font_set_funcs (font);
 
@@ -52,7 +53,10 @@ test_font (hb_font_t *font, hb_codepoint_t cp)
   hb_face_collect_variation_selectors (face, set);
   hb_face_collect_variation_unicodes (face, cp, set);
 
+  hb_ot_font_set_cmap_cache_stats_enabled (font, 1);
   hb_font_get_nominal_glyph (font, cp, &g);
+  hb_font_get_nominal_glyph (font, cp, &g);
+  hb_ot_font_get_cmap_cache_stats (font, &hits, &misses);
   hb_font_get_variation_glyph (font, cp, cp, &g);
   hb_font_get_glyph_h_advance (font, cp);
   hb_font_get_glyph_v_advance (font, cp);
@@ -170,14 +174,21 @@ test_font (hb_font_t *font, hb_codepoint_t cp)
   hb_set_destroy (set);
 
   return result + g + x + y + buf[0] + buf[1] + buf[2] + buf[3] + buf[4] + len +
-	 extents.height + extents.width + extents.x_bearing + extents.y_bearing;
+	 hits + misses + extents.height + extents.width + extents.x_bearing + extents.y_bearing;
 }
 
 #ifndef TEST_OT_FACE_NO_MAIN
 static void
 test_ot_face_empty (void)
 {
+  unsigned hits = 1, misses = 1;
+
   test_font (hb_font_get_empty (), 0);
+
+  g_assert (!hb_ot_font_set_cmap_cache_stats_enabled (hb_font_get_empty (), TRUE));
+  g_assert (!hb_ot_font_get_cmap_cache_stats (hb_font_get_empty (), &hits, &misses));
+  g_assert_cmpuint (hits, ==, 0);
+  g_assert_cmpuint (misses, ==, 0);
 }
 
 static void
@@ -188,6 +199,243 @@ test_ot_var_axis_on_zero_named_instance (void)
   hb_face_destroy (face);
 }
 
+static void
+test_ot_font_cmap_cache_stats (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_font_t *font2 = hb_font_create (face);
+  hb_codepoint_t g1 = 0, g2 = 0;
+  unsigned hits = 1, misses = 1;
+
+  /* Not counting until asked to. */
+  g_assert (hb_font_get_nominal_glyph (font, 'b', &g1));
+  g_assert (hb_ot_font_get_cmap_cache_stats (font, &hits, &misses));
+  g_assert_cmpuint (hits, ==, 0);
+  g_assert_cmpuint (misses, ==, 0);
+
+  g_assert (hb_ot_font_set_cmap_cache_stats_enabled (font, TRUE));
+  g_assert (hb_ot_font_set_cmap_cache_stats_enabled (font2, TRUE));
+
+  g_assert (hb_font_get_nominal_glyph (font, 'a', &g1));
+  g_assert (hb_ot_font_get_cmap_cache_stats (font, &hits, &misses));
+  g_assert_cmpuint (hits, ==, 0);
+  g_assert_cmpuint (misses, ==, 1);
+
+  /* A repeated lookup is served from the cache. */
+  g_assert (hb_font_get_nominal_glyph (font, 'a', &g2));
+  g_assert_cmpuint (g1, ==, g2);
+  g_assert (hb_ot_font_get_cmap_cache_stats (font, &hits, &misses));
+  g_assert_cmpuint (hits, ==, 1);
+  g_assert_cmpuint (misses, ==, 1);
+
+  /* So is one done before counting started. */
+  g_assert (hb_font_get_nominal_glyph (font, 'b', &g2));
+  g_assert (hb_ot_font_get_cmap_cache_stats (font, &hits, &misses));
+  g_assert_cmpuint (hits, ==, 2);
+  g_assert_cmpuint (misses, ==, 1);
+
+  /* The cache is per-face, and a second font sees the first one's
+   * entries, but it keeps counts of its own. */
+  g_assert (hb_font_get_nominal_glyph (font2, 'a', &g2));
+  g_assert_cmpuint (g1, ==, g2);
+  g_assert (hb_ot_font_get_cmap_cache_stats (font2, &hits, &misses));
+  g_assert_cmpuint (hits, ==, 1);
+  g_assert_cmpuint (misses, ==, 0);
+
+  /* The batch path counts each glyph. */
+  {
+    hb_codepoint_t unicodes[3] = {'a', 'b', 'c'};
+    hb_codepoint_t glyphs[3];
+    g_assert_cmpuint (hb_font_get_nominal_glyphs (font2, 3,
+						  unicodes, sizeof (unicodes[0]),
+						  glyphs, sizeof (glyphs[0])), ==, 3);
+    g_assert (hb_ot_font_get_cmap_cache_stats (font2, &hits, &misses));
+    g_assert_cmpuint (hits, ==, 3);
+    g_assert_cmpuint (misses, ==, 1);
+  }
+
+  /* Misses in cmap are never cached. */
+  g_assert (!hb_font_get_nominal_glyph (font, 'z', &g1));
+  g_assert (!hb_font_get_nominal_glyph (font, 'z', &g1));
+  g_assert (hb_ot_font_get_cmap_cache_stats (font, &hits, &misses));
+  g_assert_cmpuint (hits, ==, 2);
+  g_assert_cmpuint (misses, ==, 3);
+
+  /* Turning counting off and on again starts over. */
+  g_assert (hb_ot_font_set_cmap_cache_stats_enabled (font, FALSE));
+  g_assert (hb_font_get_nominal_glyph (font, 'a', &g1));
+  g_assert (hb_ot_font_get_cmap_cache_stats (font, &hits, &misses));
+  g_assert_cmpuint (hits, ==, 0);
+  g_assert_cmpuint (misses, ==, 0);
+  g_assert (hb_ot_font_set_cmap_cache_stats_enabled (font, TRUE));
+  g_assert (hb_ot_font_get_cmap_cache_stats (font, &hits, &misses));
+  g_assert_cmpuint (hits, ==, 0);
+  g_assert_cmpuint (misses, ==, 0);
+
+  hb_font_set_funcs (font2, hb_font_funcs_get_empty (), NULL, NULL);
+  g_assert (!hb_ot_font_set_cmap_cache_stats_enabled (font2, TRUE));
+  g_assert (!hb_ot_font_get_cmap_cache_stats (font2, &hits, &misses));
+  g_assert_cmpuint (hits, ==, 0);
+  g_assert_cmpuint (misses, ==, 0);
+
+  hb_font_destroy (font2);
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+
+  /* A flattened cmap bypasses the cache, and the counts. */
+  face = hb_test_open_font_file ("fonts/Roboto-Regular.abc.format4.ttf");
+  hb_face_set_cmap_accelerator_budget (face, 1 << 20);
+  font = hb_font_create (face);
+  g_assert (hb_ot_font_set_cmap_cache_stats_enabled (font, TRUE));
+  g_assert (hb_font_get_nominal_glyph (font, 'a', &g1));
+  g_assert (hb_font_get_nominal_glyph (font, 'a', &g2));
+  g_assert_cmpuint (g1, ==, g2);
+  g_assert (!hb_font_get_nominal_glyph (font, 'z', &g1));
+  g_assert (hb_ot_font_get_cmap_cache_stats (font, &hits, &misses));
+  g_assert_cmpuint (hits, ==, 0);
+  g_assert_cmpuint (misses, ==, 0);
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
+static void
+test_ot_font_cmap_cache_out_of_range (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_codepoint_t unicodes[] = {0xFFFF00u, 0xFFFF41u, 0x110000u, 0xFFFFFFFFu};
+  hb_codepoint_t glyphs[G_N_ELEMENTS (unicodes)];
+  hb_buffer_t *buffer;
+  hb_glyph_info_t *infos;
+  unsigned int len;
+
+  /* Codepoints too big to key the cmap cache must not match its
+   * empty slots. */
+  for (unsigned i = 0; i < G_N_ELEMENTS (unicodes); i++)
+  {
+    hb_codepoint_t g = 1;
+    g_assert (!hb_font_get_nominal_glyph (font, unicodes[i], &g));
+    g_assert_cmpuint (g, ==, 0);
+    g_assert_cmpuint (hb_font_get_nominal_glyphs (font, 1,
+						  &unicodes[i], sizeof (hb_codepoint_t),
+						  glyphs, sizeof (hb_codepoint_t)), ==, 0);
+  }
+
+  buffer = hb_buffer_create ();
+  hb_buffer_add_codepoints (buffer, unicodes, G_N_ELEMENTS (unicodes), 0, -1);
+  hb_buffer_guess_segment_properties (buffer);
+  hb_shape (font, buffer, NULL, 0);
+  infos = hb_buffer_get_glyph_infos (buffer, &len);
+  g_assert_cmpuint (len, ==, G_N_ELEMENTS (unicodes));
+  for (unsigned i = 0; i < len; i++)
+    g_assert_cmpuint (infos[i].codepoint, ==, 0);
+  hb_buffer_destroy (buffer);
+
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
+static void
+test_ot_font_cmap_accelerator_budget (void)
+{
+  const char *paths[] = {"fonts/Roboto-Regular.abc.format4.ttf",
+			 "fonts/Roboto-Regular.abc.cmap-format12-only.ttf",
+			 "fonts/Mplus1p-Regular.ttf"};
+  unsigned budgets[] = {16, 1 << 20};
+
+  for (unsigned i = 0; i < G_N_ELEMENTS (paths); i++)
+    for (unsigned j = 0; j < G_N_ELEMENTS (budgets); j++)
+    {
+      hb_face_t *face = hb_test_open_font_file (paths[i]);
+      hb_face_t *flat_face = hb_test_open_font_file (paths[i]);
+      g_assert_cmpuint (hb_face_get_cmap_accelerator_budget (flat_face), ==, 0);
+      hb_face_set_cmap_accelerator_budget (flat_face, budgets[j]);
+      g_assert_cmpuint (hb_face_get_cmap_accelerator_budget (flat_face), ==, budgets[j]);
+
+      hb_font_t *font = hb_font_create (face);
+      hb_font_t *flat_font = hb_font_create (flat_face);
+
+      /* Flattening must not change any mapping. */
+      unsigned mapped = 0;
+      for (hb_codepoint_t u = 0; u < 0x110100; u++)
+      {
+	hb_codepoint_t g = (hb_codepoint_t) -1, flat_g = (hb_codepoint_t) -1;
+	hb_bool_t found = hb_font_get_nominal_glyph (font, u, &g);
+	g_assert_cmpint (found, ==, hb_font_get_nominal_glyph (flat_font, u, &flat_g));
+	g_assert_cmpuint (g, ==, flat_g);
+	mapped += found;
+      }
+      g_assert_cmpuint (mapped, >, 0);
+
+      hb_codepoint_t unicodes[] = {'a', 'b', 'c', 0x660E, 'z'};
+      hb_codepoint_t glyphs[G_N_ELEMENTS (unicodes)], flat_glyphs[G_N_ELEMENTS (unicodes)];
+      g_assert_cmpuint (hb_font_get_nominal_glyphs (font, G_N_ELEMENTS (unicodes),
+						    unicodes, sizeof (hb_codepoint_t),
+						    glyphs, sizeof (hb_codepoint_t)), ==,
+			hb_font_get_nominal_glyphs (flat_font, G_N_ELEMENTS (unicodes),
+						    unicodes, sizeof (hb_codepoint_t),
+						    flat_glyphs, sizeof (hb_codepoint_t)));
+
+      hb_font_destroy (flat_font);
+      hb_font_destroy (font);
+      hb_face_destroy (flat_face);
+      hb_face_destroy (face);
+    }
+}
+
+static void
+test_ot_font_nominal_glyphs (void)
+{
+  const char *paths[] = {"fonts/Roboto-Regular.abc.format4.ttf",
+			 "fonts/Roboto-Regular.abc.cmap-format12-only.ttf",
+			 "fonts/Mplus1p-Regular.ttf"};
+
+  for (unsigned i = 0; i < G_N_ELEMENTS (paths); i++)
+  {
+    hb_face_t *face = hb_test_open_font_file (paths[i]);
+    hb_font_t *font = hb_font_create (face);
+    hb_set_t *unicodes = hb_set_create ();
+    hb_face_collect_unicodes (face, unicodes);
+
+    /* All mapped codepoints, in order so consecutive ones share runs, then
+     * again with each followed by its successor, which may be unmapped. */
+    unsigned count = hb_set_get_population (unicodes);
+    hb_codepoint_t *text = g_new (hb_codepoint_t, 3 * count);
+    hb_codepoint_t *glyphs = g_new (hb_codepoint_t, 3 * count);
+    unsigned len = 0;
+    for (hb_codepoint_t u = HB_SET_VALUE_INVALID; hb_set_next (unicodes, &u);)
+      text[len++] = u;
+    for (hb_codepoint_t u = HB_SET_VALUE_INVALID; hb_set_next (unicodes, &u);)
+    {
+      text[len++] = u;
+      text[len++] = u + 1;
+    }
+
+    unsigned done = hb_font_get_nominal_glyphs (font, len,
+						text, sizeof (hb_codepoint_t),
+						glyphs, sizeof (hb_codepoint_t));
+    g_assert_cmpuint (done, >=, count);
+    for (unsigned j = 0; j < done; j++)
+    {
+      hb_codepoint_t g;
+      g_assert (hb_font_get_nominal_glyph (font, text[j], &g));
+      g_assert_cmpuint (glyphs[j], ==, g);
+    }
+    if (done < len)
+    {
+      hb_codepoint_t g;
+      g_assert (!hb_font_get_nominal_glyph (font, text[done], &g));
+    }
+
+    g_free (glyphs);
+    g_free (text);
+    hb_set_destroy (unicodes);
+    hb_font_destroy (font);
+    hb_face_destroy (face);
+  }
+}
+
 int
 main (int argc, char **argv)
 {
@@ -195,6 +443,10 @@ main (int argc, char **argv)
 
   hb_test_add (test_ot_face_empty);
   hb_test_add (test_ot_var_axis_on_zero_named_instance);
+  hb_test_add (test_ot_font_cmap_cache_stats);
+  hb_test_add (test_ot_font_cmap_cache_out_of_range);
+  hb_test_add (test_ot_font_cmap_accelerator_budget);
+  hb_test_add (test_ot_font_nominal_glyphs);
 
   return hb_test_run();
 }
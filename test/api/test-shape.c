@@ -193,6 +193,257 @@ test_shape_list (void)
   g_assert (!strcmp (shapers[i - 1], "fallback"));
 }
 
+static void
+test_shape_plan_cache (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_segment_properties_t props = HB_SEGMENT_PROPERTIES_DEFAULT;
+  hb_shape_plan_t *plan1, *plan2, *plan3;
+  hb_feature_t kern_off = { HB_TAG ('k','e','r','n'), 0, HB_FEATURE_GLOBAL_START, HB_FEATURE_GLOBAL_END };
+  unsigned num_plans, hits, misses, evictions;
+
+  props.direction = HB_DIRECTION_LTR;
+  props.script = HB_SCRIPT_LATIN;
+  props.language = hb_language_from_string ("en", -1);
+
+  plan1 = hb_shape_plan_create_cached (face, &props, NULL, 0, NULL);
+  plan2 = hb_shape_plan_create_cached (face, &props, NULL, 0, NULL);
+  g_assert (plan1 == plan2);
+  hb_shape_plan_cache_get_stats (face, &num_plans, &hits, &misses, &evictions);
+  g_assert_cmpuint (num_plans, ==, 1);
+  g_assert_cmpuint (hits, ==, 1);
+  g_assert_cmpuint (misses, ==, 1);
+  g_assert_cmpuint (evictions, ==, 0);
+  hb_shape_plan_destroy (plan2);
+
+  /* A second key; with a limit of one, the first plan gets evicted
+   * from the cache but stays alive while we hold it. */
+  hb_shape_plan_cache_set_max_plans (face, 1);
+  plan3 = hb_shape_plan_create_cached (face, &props, &kern_off, 1, NULL);
+  g_assert (plan3 != plan1);
+  hb_shape_plan_cache_get_stats (face, &num_plans, &hits, &misses, &evictions);
+  g_assert_cmpuint (num_plans, ==, 1);
+  g_assert_cmpuint (misses, ==, 2);
+  g_assert_cmpuint (evictions, ==, 1);
+  g_assert_cmpstr (hb_shape_plan_get_shaper (plan1), ==, "ot");
+
+  plan2 = hb_shape_plan_create_cached (face, &props, NULL, 0, NULL);
+  g_assert (plan2 != plan1);
+  hb_shape_plan_destroy (plan2);
+
+  /* Zero disables caching altogether. */
+  hb_shape_plan_cache_set_max_plans (face, 0);
+  hb_shape_plan_cache_get_stats (face, &num_plans, NULL, NULL, &evictions);
+  g_assert_cmpuint (num_plans, ==, 0);
+  g_assert_cmpuint (evictions, ==, 3);
+  plan2 = hb_shape_plan_create_cached (face, &props, &kern_off, 1, NULL);
+  g_assert (plan2 != plan3);
+  hb_shape_plan_destroy (plan2);
+
+  hb_shape_plan_destroy (plan3);
+  hb_shape_plan_destroy (plan1);
+  hb_face_destroy (face);
+}
+
+static void
+shape_abc (hb_face_t *face, hb_codepoint_t *glyphs, hb_position_t *advances)
+{
+  hb_font_t *font = hb_font_create (face);
+  hb_buffer_t *buffer = hb_buffer_create ();
+  hb_glyph_info_t *infos;
+  hb_glyph_position_t *positions;
+  unsigned int len, i;
+
+  hb_buffer_add_utf8 (buffer, "abcabc", -1, 0, -1);
+  hb_buffer_guess_segment_properties (buffer);
+  hb_shape (font, buffer, NULL, 0);
+
+  infos = hb_buffer_get_glyph_infos (buffer, &len);
+  positions = hb_buffer_get_glyph_positions (buffer, NULL);
+  g_assert_cmpuint (len, ==, 6);
+  for (i = 0; i < len; i++)
+  {
+    glyphs[i] = infos[i].codepoint;
+    advances[i] = positions[i].x_advance;
+  }
+
+  hb_buffer_destroy (buffer);
+  hb_font_destroy (font);
+}
+
+static void
+test_shape_lookup_accelerator_budget (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_face_t *exact_face = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_codepoint_t glyphs[6], exact_glyphs[6];
+  hb_position_t advances[6], exact_advances[6];
+  unsigned int i;
+
+  g_assert_cmpuint (hb_face_get_lookup_accelerator_budget (exact_face), ==, 0);
+  hb_face_set_lookup_accelerator_budget (exact_face, 1 << 20);
+  g_assert_cmpuint (hb_face_get_lookup_accelerator_budget (exact_face), ==, 1 << 20);
+
+  /* Exact coverage must not change the output. */
+  shape_abc (face, glyphs, advances);
+  shape_abc (exact_face, exact_glyphs, exact_advances);
+  for (i = 0; i < 6; i++)
+  {
+    g_assert_cmpuint (glyphs[i], ==, exact_glyphs[i]);
+    g_assert_cmpint (advances[i], ==, exact_advances[i]);
+  }
+
+  hb_face_destroy (exact_face);
+  hb_face_destroy (face);
+}
+
+static hb_bool_t
+collect_skipped_lookups (hb_buffer_t *buffer HB_UNUSED,
+			 hb_font_t *font HB_UNUSED,
+			 const char *message,
+			 void *user_data)
+{
+  char *skipped = (char *) user_data;
+  if (!strncmp (message, "skipped lookup ", 15) &&
+      strlen (skipped) + strlen (message) < 128)
+  {
+    strncat (skipped, message + 15, strcspn (message + 15, " "));
+    strcat (skipped, ";");
+  }
+  return TRUE;
+}
+
+static void
+shape_lookup_digest (hb_font_t *font, const char *text,
+		     hb_codepoint_t expected_glyph, const char *expected_skipped)
+{
+  hb_buffer_t *buffer = hb_buffer_create ();
+  char skipped[128] = "";
+  hb_glyph_info_t *infos;
+  unsigned int len;
+
+  hb_buffer_add_utf8 (buffer, text, -1, 0, -1);
+  hb_buffer_guess_segment_properties (buffer);
+  hb_buffer_set_message_func (buffer, collect_skipped_lookups, skipped, NULL);
+  hb_shape (font, buffer, NULL, 0);
+
+  infos = hb_buffer_get_glyph_infos (buffer, &len);
+  g_assert_cmpuint (len, ==, 1);
+  g_assert_cmpuint (infos[0].codepoint, ==, expected_glyph);
+  g_assert_cmpstr (skipped, ==, expected_skipped);
+
+  hb_buffer_destroy (buffer);
+}
+
+static void
+test_shape_lookup_digest (void)
+{
+  /* Two ccmp lookups: 0 turns a (glyph 1) into b (2), 1 turns b into
+   * c (3).  Lookup 1 has nothing to do with "a" as given, but has to
+   * run once lookup 0 made a b. */
+  hb_face_t *face = hb_test_open_font_file ("fonts/gsub-digest.ttf");
+  hb_font_t *font = hb_font_create (face);
+
+  shape_lookup_digest (font, "a", 3, "");
+  shape_lookup_digest (font, "b", 3, "0;");
+  shape_lookup_digest (font, "d", 5, "0;1;");
+
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
+static hb_bool_t
+identity_glyph_func (hb_font_t *font HB_UNUSED, void *font_data HB_UNUSED,
+		     hb_codepoint_t unicode,
+		     hb_codepoint_t *glyph,
+		     void *user_data HB_UNUSED)
+{
+  if (unicode > 0x10FFFFu)
+    return FALSE;
+  *glyph = unicode;
+  return TRUE;
+}
+
+static unsigned int
+shape_codepoints (hb_font_t *font, hb_script_t script,
+		  const hb_codepoint_t *text, unsigned int text_len,
+		  hb_codepoint_t *glyphs)
+{
+  hb_buffer_t *buffer = hb_buffer_create ();
+  hb_glyph_info_t *infos;
+  unsigned int len, i;
+
+  hb_buffer_add_codepoints (buffer, text, text_len, 0, text_len);
+  hb_buffer_set_direction (buffer, HB_DIRECTION_LTR);
+  hb_buffer_set_script (buffer, script);
+  hb_shape (font, buffer, NULL, 0);
+
+  infos = hb_buffer_get_glyph_infos (buffer, &len);
+  for (i = 0; i < len; i++)
+    glyphs[i] = infos[i].codepoint;
+
+  hb_buffer_destroy (buffer);
+  return len;
+}
+
+static void
+test_shape_syllabic_categories (void)
+{
+  /* The syllabic shapers remember categories in a small table keyed by
+   * the low bits of the codepoint; U+0915, U+0995 and U+0115 all land in
+   * the same slot, and U+FFFFFFFF in the one a fresh table starts with.
+   * Shaping the syllables together must give what shaping each of them
+   * on its own does. */
+  static const hb_codepoint_t syllables[][2] = {
+    {0x0915u, 0x093Fu},
+    {0x0995u, 0x09BFu},
+    {0x0115u, 0x093Fu},
+    {0xFFFFFFFFu, 0x093Fu},
+    {0x0915u, 0x094Du},
+    {0x0995u, 0x09CDu},
+  };
+  const hb_script_t scripts[] = {HB_SCRIPT_DEVANAGARI, HB_SCRIPT_BENGALI, HB_SCRIPT_KHMER};
+  hb_face_t *face = hb_face_create (NULL, 0);
+  hb_font_t *font = hb_font_create (face);
+  hb_font_funcs_t *ffuncs = hb_font_funcs_create ();
+  unsigned int s, i, j;
+
+  hb_font_funcs_set_nominal_glyph_func (ffuncs, identity_glyph_func, NULL, NULL);
+  hb_font_set_funcs (font, ffuncs, NULL, NULL);
+
+  for (s = 0; s < G_N_ELEMENTS (scripts); s++)
+  {
+    /* Both orders, so that each syllable gets to fill the slot first. */
+    unsigned int order;
+    for (order = 0; order < 2; order++)
+    {
+      hb_codepoint_t text[2 * G_N_ELEMENTS (syllables)];
+      hb_codepoint_t glyphs[4 * G_N_ELEMENTS (syllables)];
+      hb_codepoint_t expected[4 * G_N_ELEMENTS (syllables)];
+      unsigned int len, expected_len = 0;
+
+      for (i = 0; i < G_N_ELEMENTS (syllables); i++)
+      {
+	unsigned int k = order ? G_N_ELEMENTS (syllables) - 1 - i : i;
+	text[2 * i] = syllables[k][0];
+	text[2 * i + 1] = syllables[k][1];
+	expected_len += shape_codepoints (font, scripts[s],
+					  syllables[k], 2,
+					  expected + expected_len);
+      }
+
+      len = shape_codepoints (font, scripts[s], text, G_N_ELEMENTS (text), glyphs);
+      g_assert_cmpuint (len, ==, expected_len);
+      for (j = 0; j < len; j++)
+	g_assert_cmphex (glyphs[j], ==, expected[j]);
+    }
+  }
+
+  hb_font_funcs_destroy (ffuncs);
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -203,6 +454,10 @@ main (int argc, char **argv)
   /* TODO test fallback shaper */
   /* TODO test shaper_full */
   hb_test_add (test_shape_list);
+  hb_test_add (test_shape_plan_cache);
+  hb_test_add (test_shape_lookup_accelerator_budget);
+  hb_test_add (test_shape_lookup_digest);
+  hb_test_add (test_shape_syllabic_categories);
 
   return hb_test_run();
 }
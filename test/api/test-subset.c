@@ -193,6 +193,124 @@ test_subset_plan (void)
   hb_face_destroy (face_ac);
 }
 
+static void
+_check_parallel_subset (hb_face_t *face, const hb_set_t *codepoints)
+{
+  hb_subset_input_t *input = hb_subset_test_create_input (codepoints);
+  hb_face_t *subset, *parallel_subset;
+  hb_blob_t *blob, *parallel_blob;
+
+  subset = hb_subset_or_fail (face, input);
+  hb_subset_input_set_flags (input, HB_SUBSET_FLAGS_PARALLEL_TABLES);
+  parallel_subset = hb_subset_or_fail (face, input);
+  g_assert (subset);
+  g_assert (parallel_subset);
+
+  /* Must produce the very same font. */
+  blob = hb_face_reference_blob (subset);
+  parallel_blob = hb_face_reference_blob (parallel_subset);
+  g_assert_cmpuint (hb_blob_get_length (blob), ==, hb_blob_get_length (parallel_blob));
+  g_assert (!memcmp (hb_blob_get_data (blob, NULL),
+		     hb_blob_get_data (parallel_blob, NULL),
+		     hb_blob_get_length (blob)));
+
+  hb_blob_destroy (parallel_blob);
+  hb_blob_destroy (blob);
+  hb_face_destroy (parallel_subset);
+  hb_face_destroy (subset);
+  hb_subset_input_destroy (input);
+}
+
+static void
+test_subset_parallel_tables (void)
+{
+  const char *fonts[] = {"fonts/Roboto-Regular.abc.ttf",
+			 "fonts/SourceSansPro-Regular.otf",
+			 "fonts/NotoNastaliqUrdu-Regular.ttf"};
+  unsigned i;
+
+  for (i = 0; i < G_N_ELEMENTS (fonts); i++)
+  {
+    hb_face_t *face = hb_test_open_font_file (fonts[i]);
+    hb_set_t *codepoints = hb_set_create ();
+
+    hb_set_add (codepoints, 'a');
+    hb_set_add (codepoints, 'c');
+    _check_parallel_subset (face, codepoints);
+
+    /* Large enough for the tables to be subset at the same time,
+     * so that races show up under ThreadSanitizer. */
+    hb_face_collect_unicodes (face, codepoints);
+    _check_parallel_subset (face, codepoints);
+
+    hb_set_destroy (codepoints);
+    hb_face_destroy (face);
+  }
+}
+
+static hb_face_t *
+_subset_test_subset_codepoints (hb_face_t *face, const char *text)
+{
+  hb_set_t *codepoints = hb_set_create ();
+  hb_subset_input_t *input;
+  hb_face_t *subset;
+
+  for (; *text; text++)
+    hb_set_add (codepoints, *text);
+  input = hb_subset_test_create_input (codepoints);
+  hb_set_destroy (codepoints);
+
+  subset = hb_subset_or_fail (face, input);
+  g_assert (subset);
+
+  hb_subset_input_destroy (input);
+  return subset;
+}
+
+static void
+test_subset_preprocess (void)
+{
+  const char *fonts[] = {"fonts/Roboto-Regular.abc.ttf",
+			 "fonts/SourceSansPro-Regular.otf",
+			 "fonts/AdobeVFPrototype.abc.otf",
+			 "../subset/data/fonts/Roboto-Regular.ttf"};
+  const char *texts[] = {"ac", "fi", "abc"};
+  unsigned i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (fonts); i++)
+  {
+    hb_face_t *face = hb_test_open_font_file (fonts[i]);
+    hb_face_t *preprocessed = hb_subset_preprocess (face);
+
+    /* Subsets of the preprocessed face must match regular ones. */
+    for (j = 0; j < G_N_ELEMENTS (texts); j++)
+    {
+      hb_face_t *expected, *subset;
+      hb_blob_t *expected_blob, *blob;
+
+      hb_face_t *fresh = hb_test_open_font_file (fonts[i]);
+      expected = _subset_test_subset_codepoints (fresh, texts[j]);
+      hb_face_destroy (fresh);
+      subset = _subset_test_subset_codepoints (preprocessed, texts[j]);
+
+      expected_blob = hb_face_reference_blob (expected);
+      blob = hb_face_reference_blob (subset);
+      g_assert_cmpuint (hb_blob_get_length (expected_blob), ==, hb_blob_get_length (blob));
+      g_assert (!memcmp (hb_blob_get_data (expected_blob, NULL),
+			 hb_blob_get_data (blob, NULL),
+			 hb_blob_get_length (blob)));
+
+      hb_blob_destroy (blob);
+      hb_blob_destroy (expected_blob);
+      hb_face_destroy (subset);
+      hb_face_destroy (expected);
+    }
+
+    hb_face_destroy (preprocessed);
+    hb_face_destroy (face);
+  }
+}
+
 int
 main (int argc, char **argv)
 {
@@ -204,6 +322,8 @@ main (int argc, char **argv)
   hb_test_add (test_subset_set_flags);
   hb_test_add (test_subset_sets);
   hb_test_add (test_subset_plan);
+  hb_test_add (test_subset_parallel_tables);
+  hb_test_add (test_subset_preprocess);
 
   return hb_test_run();
 }
@@ -91,11 +91,43 @@ test_get_var_get_axis_infos (void)
   hb_face_destroy (face);
 }
 
+static void
+test_var_coords_advance_cache (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/SourceSansVariable-Roman.abc.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_codepoint_t glyph;
+  hb_variation_t var = { HB_TAG ('w','g','h','t'), 900.f };
+
+  g_assert (hb_font_get_nominal_glyph (font, 'a', &glyph));
+  hb_position_t regular = hb_font_get_glyph_h_advance (font, glyph);
+
+  /* Repeated queries are answered from the advance cache; changing
+   * variations or scale must not return stale values. */
+  hb_font_set_variations (font, &var, 1);
+  hb_position_t black = hb_font_get_glyph_h_advance (font, glyph);
+  g_assert_cmpint (black, !=, regular);
+  g_assert_cmpint (hb_font_get_glyph_h_advance (font, glyph), ==, black);
+
+  hb_font_set_scale (font, 2 * hb_face_get_upem (face), 2 * hb_face_get_upem (face));
+  g_assert_cmpint (hb_font_get_glyph_h_advance (font, glyph), ==, 2 * black);
+
+  hb_font_set_var_coords_normalized (font, NULL, 0);
+  g_assert_cmpint (hb_font_get_glyph_h_advance (font, glyph), ==, 2 * regular);
+
+  hb_font_set_variations (font, &var, 1);
+  g_assert_cmpint (hb_font_get_glyph_h_advance (font, glyph), ==, 2 * black);
+
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
 int
 main (int argc, char **argv)
 {
   hb_test_init (&argc, &argv);
   hb_test_add (test_get_var_coords);
   hb_test_add (test_get_var_get_axis_infos);
+  hb_test_add (test_var_coords_advance_cache);
   return hb_test_run ();
 }